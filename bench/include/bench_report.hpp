@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace Bench {
+/// Timing results for one benchmark case.
+struct Measurement {
+  std::string name;
+  size_t tokens{0};
+  size_t iterations{0};
+  double min_ns{0.0};
+  double median_ns{0.0};
+  double mean_ns{0.0};
+};
+
+using Measurements = std::vector<Measurement>;
+
+// Write measurements as a JSON document.
+void write_json(std::ostream &outs, const Measurements &measurements);
+
+// Read measurements from a JSON document produced by write_json.
+// Throws std::runtime_error if the document can't be parsed.
+Measurements read_json(std::istream &ins);
+
+// Print a human-readable table of measurements.
+void write_table(std::ostream &outs, const Measurements &measurements);
+
+// Compare current median timings against a baseline.  Answer the number of
+// benchmarks whose median slowed down by more than threshold_pct percent.
+size_t compare(std::ostream &outs, const Measurements &baseline,
+               const Measurements &current, double threshold_pct);
+} // namespace Bench
@@ -0,0 +1,628 @@
+#include "arg_parse.hpp"
+#include "bench_report.hpp"
+#include "command_line.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+using namespace ArgParse;
+
+/// A command line, and the strings it views.
+struct ArgStore {
+  std::vector<std::string> m_strs{"<exe>"};
+  std::vector<std::string_view> m_seq;
+
+  void add(std::string s) { m_strs.push_back(std::move(s)); }
+
+  [[nodiscard]] size_t num_tokens() const { return m_strs.size() - 1; }
+};
+
+using ArgStorePtr = std::shared_ptr<const ArgStore>;
+
+// Freeze a command line.  The views are built only after the strings have
+// reached their final home.
+ArgStorePtr finish(ArgStore &&store) {
+  auto result = std::make_shared<ArgStore>(std::move(store));
+  result->m_seq.assign(result->m_strs.begin(), result->m_strs.end());
+  return result;
+}
+
+/// Discards everything written to it.
+struct NullBuf : public std::streambuf {
+  int overflow(int c) override { return c; }
+  std::streamsize xsputn(const char *, std::streamsize n) override {
+    return n;
+  }
+};
+
+/// Silences cout and cerr while in scope.
+class Silence {
+  NullBuf m_null;
+  std::streambuf *const m_cout;
+  std::streambuf *const m_cerr;
+
+public:
+  Silence()
+      : m_cout(std::cout.rdbuf(&m_null)), m_cerr(std::cerr.rdbuf(&m_null)) {}
+  ~Silence() {
+    std::cout.rdbuf(m_cout);
+    std::cerr.rdbuf(m_cerr);
+  }
+};
+
+using Runner = std::function<void()>;
+
+/// A benchmark case.  setup() is called, untimed, before every timed run
+/// because parsers accumulate state as they parse.
+struct Case {
+  std::string name;
+  size_t tokens;
+  bool extreme;
+  std::function<Runner()> setup;
+};
+
+std::string padded(size_t i) {
+  std::ostringstream outs;
+  outs << std::setw(4) << std::setfill('0') << i;
+  return outs.str();
+}
+
+// Names are zero-padded so that no long name is a prefix of another.
+std::string short_name(size_t i) { return "-o" + padded(i); }
+std::string long_name(size_t i) { return "--opt-" + padded(i); }
+
+ArgumentParser::Ptr parser_with_options(size_t num_options) {
+  auto parser = ArgumentParser::create("Benchmark parser.");
+  for (size_t i = 0; i < num_options; ++i) {
+    option<int>(parser, short_name(i), long_name(i), "An integer option.");
+  }
+  return parser;
+}
+
+// The names of single-character flags: every letter but "h", which names
+// the help flag.
+constexpr std::string_view flag_chars =
+    "abcdefgijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+ArgumentParser::Ptr parser_with_flags() {
+  auto parser = ArgumentParser::create("Benchmark parser.");
+  for (const char c : flag_chars) {
+    flag(parser, std::string("-") + c, std::string("--flag-") + c, "A flag.");
+  }
+  return parser;
+}
+
+Runner parse_runner(ArgumentParser::Ptr parser, ArgStorePtr args) {
+  return [parser, args]() { parser->parse_args(args->m_seq); };
+}
+
+enum class OptForm { long_eq, short_sep };
+
+Case options_case(size_t num_options, OptForm form) {
+  // Refer to 64 options spread evenly across the registered ones, so that
+  // a linear scan can't get lucky.
+  const size_t num_refs = 64;
+  ArgStore store;
+  for (size_t k = 0; k < num_refs; ++k) {
+    const size_t i = k * (num_options - 1) / (num_refs - 1);
+    if (form == OptForm::long_eq) {
+      store.add(long_name(i) + "=" + std::to_string(k));
+    } else {
+      store.add(short_name(i));
+      store.add(std::to_string(k));
+    }
+  }
+
+  auto args = finish(std::move(store));
+  const std::string form_name =
+      (form == OptForm::long_eq) ? "long_eq" : "short_sep";
+  return {"options_" + form_name + "/" + std::to_string(num_options),
+          args->num_tokens(), num_options >= 5000, [=]() {
+            return parse_runner(parser_with_options(num_options), args);
+          }};
+}
+
+template <typename T>
+Case positionals_case(std::string_view type_name, size_t num_values) {
+  ArgStore store;
+  for (size_t i = 0; i < num_values; ++i) {
+    if constexpr (std::is_integral_v<T>) {
+      store.add(std::to_string(i));
+    } else {
+      store.add(std::to_string(i) + ".5");
+    }
+  }
+
+  auto args = finish(std::move(store));
+  return {"positionals_" + std::string(type_name) + "/" +
+              std::to_string(num_values),
+          num_values, num_values >= 100000, [=]() {
+            auto parser = ArgumentParser::create("Benchmark parser.");
+            argument<T>(parser, "values", Nargs::one_or_more, "Values.");
+            return parse_runner(parser, args);
+          }};
+}
+
+// Positionals converted in parallel once all have been parsed.
+Case parallel_case(size_t num_values) {
+  ArgStore store;
+  for (size_t i = 0; i < num_values; ++i) {
+    store.add(std::to_string(i) + ".5");
+  }
+
+  auto args = finish(std::move(store));
+  return {"positionals_parallel_double/" + std::to_string(num_values),
+          num_values, num_values >= 100000, [=]() {
+            auto parser = ArgumentParser::create("Benchmark parser.");
+            argument<double>(parser, "values", Nargs::one_or_more, "Values.")
+                ->convert_in_parallel();
+            return parse_runner(parser, args);
+          }};
+}
+
+// Positionals handed to a sink rather than kept.
+Case streaming_case(size_t num_values) {
+  ArgStore store;
+  for (size_t i = 0; i < num_values; ++i) {
+    store.add(std::to_string(i));
+  }
+
+  auto args = finish(std::move(store));
+  return {"positionals_streaming_int/" + std::to_string(num_values),
+          num_values, num_values >= 100000, [=]() {
+            auto parser = ArgumentParser::create("Benchmark parser.");
+            auto sum = std::make_shared<long long>(0);
+            streaming_argument<int>(
+                parser, "values", Nargs::one_or_more, "Values.",
+                [sum](int &&value) { *sum += value; });
+            return parse_runner(parser, args);
+          }};
+}
+
+// One parser, reset and reused for every run.
+Case reparse_case(size_t num_values) {
+  ArgStore store;
+  store.add("--flag");
+  store.add("--value=42");
+  for (size_t i = 0; i < num_values; ++i) {
+    store.add(std::to_string(i));
+  }
+
+  auto args = finish(std::move(store));
+  auto parser = ArgumentParser::create("Benchmark parser.");
+  flag(parser, "-f", "--flag", "A flag.");
+  option<int>(parser, "-v", "--value", "A value.");
+  argument<int>(parser, "values", Nargs::one_or_more, "Values.");
+  return {"reparse_int/" + std::to_string(num_values), args->num_tokens(),
+          false, [=]() -> Runner {
+            return [parser, args]() {
+              parser->reset();
+              parser->parse_args(args->m_seq);
+            };
+          }};
+}
+
+/// A response file, removed when this is destroyed.
+struct ResponseFile {
+  std::filesystem::path m_path;
+
+  ResponseFile(std::filesystem::path path, size_t num_values)
+      : m_path(std::move(path)) {
+    std::ofstream outs(m_path);
+    for (size_t i = 0; i < num_values; ++i) {
+      outs << "file-" << padded(i % 10000) << ".txt\n";
+    }
+  }
+
+  ~ResponseFile() { std::filesystem::remove(m_path); }
+};
+
+// Positionals read from a response file into string_views, so that no
+// token is copied.  The file is written on first use.
+Case response_file_case(size_t num_values) {
+  auto file = std::make_shared<std::unique_ptr<ResponseFile>>();
+  return {"response_file/" + std::to_string(num_values), num_values,
+          num_values >= 1000000, [=]() {
+            if (!*file) {
+              *file = std::make_unique<ResponseFile>(
+                  std::filesystem::temp_directory_path() /
+                      ("arg_parse_bench_" + std::to_string(num_values) +
+                       ".rsp"),
+                  num_values);
+            }
+            ArgStore store;
+            store.add("@" + (*file)->m_path.string());
+            auto parser = ArgumentParser::create("Benchmark parser.");
+            parser->enable_response_files();
+            argument<std::string_view>(parser, "files", Nargs::one_or_more,
+                                       "Files.");
+            return parse_runner(parser, finish(std::move(store)));
+          }};
+}
+
+/// A config file of feature flags, removed when it goes out of scope.
+struct ConfigFile {
+  std::filesystem::path m_path;
+
+  ConfigFile(std::filesystem::path path, size_t num_keys)
+      : m_path(std::move(path)) {
+    std::ofstream outs(m_path);
+    outs << "# Feature flags\n";
+    for (size_t i = 0; i < num_keys; ++i) {
+      outs << "feature-" << padded(i) << " = " << (i % 2) << "\n";
+    }
+  }
+
+  ~ConfigFile() { std::filesystem::remove(m_path); }
+};
+
+// Load a large config file of which 64 keys name options.  The timed parse
+// includes mapping and indexing the file.  The file is written on first use.
+Case config_case(size_t num_keys) {
+  const size_t num_options = 64;
+  auto file = std::make_shared<std::unique_ptr<ConfigFile>>();
+  auto args = finish(ArgStore());
+  return {"config_file/" + std::to_string(num_keys), num_keys,
+          num_keys >= 100000, [=]() -> Runner {
+            if (!*file) {
+              *file = std::make_unique<ConfigFile>(
+                  std::filesystem::temp_directory_path() /
+                      ("arg_parse_bench_" + std::to_string(num_keys) +
+                       ".ini"),
+                  num_keys);
+            }
+            auto parser = ArgumentParser::create("Benchmark parser.");
+            for (size_t k = 0; k < num_options; ++k) {
+              const size_t i = k * (num_keys - 1) / (num_options - 1);
+              flag(parser, "", "--feature-" + padded(i), "A feature.");
+            }
+            const std::string path = (*file)->m_path.string();
+            return [parser, args, path]() {
+              if (parser->load_config(path)) {
+                std::abort();
+              }
+              parser->parse_args(args->m_seq);
+            };
+          }};
+}
+
+// Split a command line of mostly plain words, with some quoted or escaped
+// ones, reusing one CommandLine.
+Case split_case(size_t num_words) {
+  auto line = std::make_shared<std::string>("cmd");
+  for (size_t i = 1; i < num_words; ++i) {
+    switch (i % 8) {
+    case 0:
+      *line += " \"quoted words " + padded(i % 10000) + "\"";
+      break;
+    case 4:
+      *line += " escaped\\ " + padded(i % 10000);
+      break;
+    default:
+      *line += " --option-" + padded(i % 10000) + "=value";
+      break;
+    }
+  }
+  return {"split_command_line/" + std::to_string(num_words), num_words,
+          num_words >= 1000000, [=]() -> Runner {
+            auto command_line = std::make_shared<CommandLine>();
+            return [line, command_line]() { command_line->assign(*line); };
+          }};
+}
+
+Case choice_case(size_t num_choices) {
+  std::vector<std::string> choices;
+  for (size_t i = 0; i < num_choices; ++i) {
+    choices.push_back("choice-" + padded(i));
+  }
+
+  // Pick values near the end of the list, in a different case.
+  const size_t num_refs = 100;
+  ArgStore store;
+  for (size_t k = 0; k < num_refs; ++k) {
+    store.add("-c");
+    store.add("CHOICE-" + padded(num_choices - 1 - (k % 4)));
+  }
+
+  auto args = finish(std::move(store));
+  return {"choice/" + std::to_string(num_choices), args->num_tokens(), false,
+          [=]() {
+            auto parser = ArgumentParser::create("Benchmark parser.");
+            choice(parser, "-c", "--choice", "A choice.", choices);
+            return parse_runner(parser, args);
+          }};
+}
+
+Case help_case(size_t num_options) {
+  ArgStore store;
+  store.add("--help");
+  auto args = finish(std::move(store));
+  return {"show_help/" + std::to_string(num_options), args->num_tokens(),
+          num_options >= 5000, [=]() {
+            auto parser = parser_with_options(num_options);
+            argument<std::string>(parser, "files", Nargs::zero_or_more,
+                                  "Files.");
+            return parse_runner(parser, args);
+          }};
+}
+
+// Show help repeatedly with one parser, as introspection scripts do.
+Case help_repeat_case(size_t num_options) {
+  ArgStore store;
+  store.add("--help");
+  auto args = finish(std::move(store));
+  auto parser = parser_with_options(num_options);
+  choice(parser, "-c", "--choice", "A choice.", {"red", "green", "blue"});
+  argument<std::string>(parser, "files", Nargs::zero_or_more, "Files.");
+  return {"show_help_repeat/" + std::to_string(num_options),
+          args->num_tokens(), false, [=]() -> Runner {
+            return [parser, args]() {
+              parser->reset();
+              parser->parse_args(args->m_seq);
+            };
+          }};
+}
+
+Case error_case(size_t num_options) {
+  ArgStore store;
+  store.add(long_name(num_options / 2) + "=1");
+  store.add("--no-such-option");
+  auto args = finish(std::move(store));
+  return {"unknown_option/" + std::to_string(num_options), args->num_tokens(),
+          num_options >= 5000, [=]() {
+            return parse_runner(parser_with_options(num_options), args);
+          }};
+}
+
+// Mistype options with one parser, as wrappers validating lists of options
+// do.  Each error suggests the nearest names, so every name is compared.
+Case suggest_case(size_t num_options) {
+  ArgStore store;
+  store.add(long_name(num_options / 2) + "x");
+  auto args = finish(std::move(store));
+  auto parser = parser_with_options(num_options);
+  return {"suggest_option/" + std::to_string(num_options), args->num_tokens(),
+          false, [=]() -> Runner {
+            return [parser, args]() {
+              parser->reset();
+              parser->parse_args(args->m_seq);
+            };
+          }};
+}
+
+// Set every single-character flag, each in its own argument or all in one
+// cluster, "-abc...".
+Case flags_case(bool clustered) {
+  ArgStore store;
+  if (clustered) {
+    store.add("-" + std::string(flag_chars));
+  } else {
+    for (const char c : flag_chars) {
+      store.add(std::string("-") + c);
+    }
+  }
+  auto args = finish(std::move(store));
+  return {clustered ? "flags_clustered/51" : "flags_separate/51",
+          args->num_tokens(), false,
+          [=]() { return parse_runner(parser_with_flags(), args); }};
+}
+
+// Invoke one of many subcommands, each with options of its own.  Only the
+// invoked subcommand's parser should be built.
+Case subcommand_case(size_t num_commands) {
+  const size_t num_options = 20;
+  ArgStore store;
+  store.add("verb-" + padded(num_commands / 2));
+  store.add(long_name(num_options / 2) + "=1");
+  auto args = finish(std::move(store));
+  return {"subcommands/" + std::to_string(num_commands), args->num_tokens(),
+          false, [=]() {
+            auto parser = ArgumentParser::create("Benchmark parser.");
+            for (size_t i = 0; i < num_commands; ++i) {
+              parser->add_subcommand(
+                  "verb-" + padded(i), "A subcommand.",
+                  [](ArgumentParser::Ptr subparser) {
+                    for (size_t j = 0; j < num_options; ++j) {
+                      option<int>(subparser, short_name(j), long_name(j),
+                                  "An integer option.");
+                    }
+                  });
+            }
+            return parse_runner(parser, args);
+          }};
+}
+
+// Reject an invalid value, as a wrapper probing several parsers would, with
+// output discarded.
+Case rejected_case(size_t num_options) {
+  ArgStore store;
+  store.add(long_name(num_options / 2) + "=1");
+  store.add(long_name(num_options / 4) + "=not-a-number");
+  auto args = finish(std::move(store));
+  return {"rejected_discarded/" + std::to_string(num_options),
+          args->num_tokens(), num_options >= 5000, [=]() {
+            auto parser = parser_with_options(num_options);
+            parser->set_output(OutputSink::discard());
+            return parse_runner(parser, args);
+          }};
+}
+
+// Give every option an environment variable, and set half of them.  The
+// timed parse includes reading the environment.
+Case env_case(size_t num_options) {
+  const auto env_name = [](size_t i) { return "ARG_PARSE_BENCH_" + padded(i); };
+  for (size_t i = 0; i < num_options; i += 2) {
+    setenv(env_name(i).c_str(), std::to_string(i).c_str(), 1);
+  }
+  ArgStore store;
+  store.add(long_name(num_options / 2) + "=1");
+  auto args = finish(std::move(store));
+  return {"env_options/" + std::to_string(num_options), args->num_tokens(),
+          num_options >= 5000, [=]() {
+            auto parser = ArgumentParser::create("Benchmark parser.");
+            for (size_t i = 0; i < num_options; ++i) {
+              option<int>(parser, short_name(i), long_name(i),
+                          "An integer option.")
+                  ->set_env_var(env_name(i));
+            }
+            return parse_runner(parser, args);
+          }};
+}
+
+std::vector<Case> all_cases() {
+  std::vector<Case> result;
+  for (const size_t n : {10, 100, 1000, 5000}) {
+    result.push_back(options_case(n, OptForm::long_eq));
+    result.push_back(options_case(n, OptForm::short_sep));
+  }
+  result.push_back(flags_case(false));
+  result.push_back(flags_case(true));
+  for (const size_t n : {1, 1000, 100000, 1000000}) {
+    result.push_back(positionals_case<int>("int", n));
+    result.push_back(positionals_case<double>("double", n));
+    result.push_back(positionals_case<std::string>("string", n));
+    result.push_back(streaming_case(n));
+    result.push_back(parallel_case(n));
+  }
+  for (const size_t n : {1, 1000}) {
+    result.push_back(reparse_case(n));
+  }
+  for (const size_t n : {1000, 100000, 1000000}) {
+    result.push_back(response_file_case(n));
+    result.push_back(split_case(n));
+  }
+  for (const size_t n : {1000, 10000, 100000}) {
+    result.push_back(config_case(n));
+  }
+  for (const size_t n : {10, 100, 500}) {
+    result.push_back(choice_case(n));
+    result.push_back(subcommand_case(n));
+  }
+  for (const size_t n : {10, 1000, 5000}) {
+    result.push_back(help_case(n));
+    result.push_back(help_repeat_case(n));
+    result.push_back(error_case(n));
+    result.push_back(suggest_case(n));
+    result.push_back(rejected_case(n));
+    result.push_back(env_case(n));
+  }
+  return result;
+}
+
+Bench::Measurement measure(const Case &c, double min_seconds) {
+  using Clock = std::chrono::steady_clock;
+  const size_t min_iterations = 3;
+  const size_t max_iterations = 10000;
+
+  std::vector<double> samples;
+  double total_ns = 0.0;
+  {
+    Silence silence;
+    // Warm up.
+    c.setup()();
+
+    while ((samples.size() < min_iterations) ||
+           ((total_ns < min_seconds * 1.0e9) &&
+            (samples.size() < max_iterations))) {
+      auto run = c.setup();
+      const auto t0 = Clock::now();
+      run();
+      const auto t1 = Clock::now();
+      const double ns =
+          std::chrono::duration<double, std::nano>(t1 - t0).count();
+      samples.push_back(ns);
+      total_ns += ns;
+    }
+  }
+
+  std::sort(samples.begin(), samples.end());
+  Bench::Measurement result;
+  result.name = c.name;
+  result.tokens = c.tokens;
+  result.iterations = samples.size();
+  result.min_ns = samples.front();
+  result.median_ns = samples[samples.size() / 2];
+  result.mean_ns = total_ns / samples.size();
+  return result;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  auto parser = ArgumentParser::create(
+      "Time ArgumentParser::parse_args for a range of command-line shapes.");
+  auto json_path = option<std::filesystem::path>(
+      parser, "-j", "--json", "Write results as JSON to this file.");
+  auto baseline_path = option<std::filesystem::path>(
+      parser, "-c", "--compare",
+      "Compare results against this JSON baseline.  Exit with status 1 if "
+      "any benchmark regressed.");
+  auto threshold =
+      option<double>(parser, "-t", "--threshold",
+                     "Allowed slowdown, in percent, before a comparison is "
+                     "reported as a regression.",
+                     10.0);
+  auto filter = option<std::string>(
+      parser, "-f", "--filter", "Run only benchmarks whose names contain this.");
+  auto min_time = option<double>(
+      parser, "-m", "--min-time", "Minimum seconds to spend per benchmark.",
+      0.25);
+  auto quick = flag(parser, "-q", "--quick",
+                    "Skip the most extreme (slowest) benchmark shapes.");
+
+  parser->parse_args(argc, argv);
+  if (parser->should_exit()) {
+    return parser->exit_code();
+  }
+
+  Bench::Measurements baseline;
+  if (!baseline_path->value().empty()) {
+    std::ifstream ins(baseline_path->value());
+    if (!ins) {
+      std::cerr << "Cannot read baseline " << baseline_path->value()
+                << std::endl;
+      return 2;
+    }
+    baseline = Bench::read_json(ins);
+  }
+
+  Bench::Measurements results;
+  for (const auto &c : all_cases()) {
+    if (quick->is_set() && c.extreme) {
+      continue;
+    }
+    if (c.name.find(filter->value()) == std::string::npos) {
+      continue;
+    }
+    std::cerr << "Running " << c.name << "..." << std::endl;
+    results.push_back(measure(c, min_time->value()));
+  }
+
+  Bench::write_table(std::cout, results);
+
+  if (!json_path->value().empty()) {
+    std::ofstream outs(json_path->value());
+    Bench::write_json(outs, results);
+    if (!outs) {
+      std::cerr << "Cannot write " << json_path->value() << std::endl;
+      return 2;
+    }
+  }
+
+  if (!baseline_path->value().empty()) {
+    std::cout << std::endl;
+    if (Bench::compare(std::cout, baseline, results, threshold->value()) > 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,213 @@
+#include "bench_report.hpp"
+
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace Bench {
+namespace {
+// Escapes as JSON requires.  Call it qualified: std::quoted is found by
+// argument-dependent lookup for std::string arguments.
+std::string quoted(std::string_view s) {
+  std::string result("\"");
+  for (const char c : s) {
+    if ((c == '"') || (c == '\\')) {
+      result += '\\';
+    }
+    result += c;
+  }
+  result += '"';
+  return result;
+}
+
+// A minimal reader for the flat documents written by write_json.
+struct JsonReader {
+  std::string m_text;
+  size_t m_pos{0};
+
+  explicit JsonReader(std::istream &ins)
+      : m_text(std::istreambuf_iterator<char>(ins), {}) {}
+
+  [[noreturn]] void fail(std::string_view what) const {
+    throw std::runtime_error("Malformed benchmark JSON at offset " +
+                             std::to_string(m_pos) + ": " + std::string(what));
+  }
+
+  void skip_ws() {
+    while ((m_pos < m_text.size()) &&
+           std::isspace(static_cast<unsigned char>(m_text[m_pos]))) {
+      ++m_pos;
+    }
+  }
+
+  bool accept(char c) {
+    skip_ws();
+    if ((m_pos < m_text.size()) && (m_text[m_pos] == c)) {
+      ++m_pos;
+      return true;
+    }
+    return false;
+  }
+
+  void expect(char c) {
+    if (!accept(c)) {
+      fail(std::string("expected '") + c + "'");
+    }
+  }
+
+  std::string string_value() {
+    expect('"');
+    std::string result;
+    while (m_pos < m_text.size()) {
+      const char c = m_text[m_pos++];
+      if (c == '"') {
+        return result;
+      }
+      if ((c == '\\') && (m_pos < m_text.size())) {
+        result += m_text[m_pos++];
+      } else {
+        result += c;
+      }
+    }
+    fail("unterminated string");
+  }
+
+  double number_value() {
+    skip_ws();
+    const char *begin = m_text.c_str() + m_pos;
+    char *end = nullptr;
+    const double result = std::strtod(begin, &end);
+    if (end == begin) {
+      fail("expected a number");
+    }
+    m_pos += end - begin;
+    return result;
+  }
+
+  Measurement measurement() {
+    Measurement result;
+    expect('{');
+    if (accept('}')) {
+      return result;
+    }
+    do {
+      const std::string key = string_value();
+      expect(':');
+      if (key == "name") {
+        result.name = string_value();
+      } else if (key == "tokens") {
+        result.tokens = static_cast<size_t>(number_value());
+      } else if (key == "iterations") {
+        result.iterations = static_cast<size_t>(number_value());
+      } else if (key == "min_ns") {
+        result.min_ns = number_value();
+      } else if (key == "median_ns") {
+        result.median_ns = number_value();
+      } else if (key == "mean_ns") {
+        result.mean_ns = number_value();
+      } else {
+        fail("unknown key '" + key + "'");
+      }
+    } while (accept(','));
+    expect('}');
+    return result;
+  }
+
+  Measurements document() {
+    Measurements result;
+    expect('{');
+    if (string_value() != "benchmarks") {
+      fail("expected \"benchmarks\"");
+    }
+    expect(':');
+    expect('[');
+    if (!accept(']')) {
+      do {
+        result.push_back(measurement());
+      } while (accept(','));
+      expect(']');
+    }
+    expect('}');
+    return result;
+  }
+};
+} // namespace
+
+void write_json(std::ostream &outs, const Measurements &measurements) {
+  outs << "{\n  \"benchmarks\": [";
+  std::string sep = "\n";
+  outs << std::fixed << std::setprecision(1);
+  for (const auto &m : measurements) {
+    outs << sep << "    {\"name\": " << Bench::quoted(m.name)
+         << ", \"tokens\": " << m.tokens << ", \"iterations\": " << m.iterations
+         << ", \"min_ns\": " << m.min_ns << ", \"median_ns\": " << m.median_ns
+         << ", \"mean_ns\": " << m.mean_ns << "}";
+    sep = ",\n";
+  }
+  outs << "\n  ]\n}\n";
+}
+
+Measurements read_json(std::istream &ins) {
+  JsonReader reader(ins);
+  return reader.document();
+}
+
+void write_table(std::ostream &outs, const Measurements &measurements) {
+  outs << std::left << std::setw(36) << "benchmark" << std::right
+       << std::setw(10) << "tokens" << std::setw(8) << "iters" << std::setw(16)
+       << "median (us)" << std::setw(16) << "min (us)" << std::setw(12)
+       << "ns/token" << std::endl;
+  outs << std::fixed << std::setprecision(2);
+  for (const auto &m : measurements) {
+    const double per_token = m.tokens ? (m.median_ns / m.tokens) : 0.0;
+    outs << std::left << std::setw(36) << m.name << std::right
+         << std::setw(10) << m.tokens << std::setw(8) << m.iterations
+         << std::setw(16) << m.median_ns / 1000.0 << std::setw(16)
+         << m.min_ns / 1000.0 << std::setw(12) << per_token << std::endl;
+  }
+}
+
+size_t compare(std::ostream &outs, const Measurements &baseline,
+               const Measurements &current, double threshold_pct) {
+  std::map<std::string, Measurement> by_name;
+  for (const auto &m : baseline) {
+    by_name[m.name] = m;
+  }
+
+  size_t num_regressions = 0;
+  outs << std::left << std::setw(36) << "benchmark" << std::right
+       << std::setw(16) << "baseline (us)" << std::setw(16) << "current (us)"
+       << std::setw(10) << "change" << std::endl;
+  outs << std::fixed << std::setprecision(2);
+  for (const auto &m : current) {
+    const auto found = by_name.find(m.name);
+    outs << std::left << std::setw(36) << m.name << std::right;
+    if ((found == by_name.end()) || (found->second.median_ns <= 0.0)) {
+      outs << std::setw(16) << "-" << std::setw(16) << m.median_ns / 1000.0
+           << std::setw(10) << "new" << std::endl;
+      continue;
+    }
+
+    const double base_ns = found->second.median_ns;
+    const double change_pct = 100.0 * (m.median_ns - base_ns) / base_ns;
+    const bool regressed = change_pct > threshold_pct;
+    if (regressed) {
+      ++num_regressions;
+    }
+    std::ostringstream change;
+    change << std::showpos << std::fixed << std::setprecision(1) << change_pct
+           << "%";
+    outs << std::setw(16) << base_ns / 1000.0 << std::setw(16)
+         << m.median_ns / 1000.0 << std::setw(10) << change.str()
+         << (regressed ? "  REGRESSION" : "") << std::endl;
+  }
+
+  outs << num_regressions << " regression(s) beyond " << threshold_pct << "%."
+       << std::endl;
+  return num_regressions;
+}
+} // namespace Bench
@@ -0,0 +1,184 @@
+// Times how long a small tool takes from exec until it has parsed its
+// command line and exited, for each way of linking the library.
+#include "arg_parse.hpp"
+#include "bench_report.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <spawn.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+extern "C" char **environ;
+
+namespace {
+using namespace ArgParse;
+
+// A typical command line.
+const std::vector<std::string> cli_args{
+    "-v", "--output=/tmp/out", "-j", "4",     "--mode", "link",
+    "-r", "0.5",               "a",  "b.txt", "c.txt"};
+
+// A shell completion script's request for the values of --output, which are
+// listed by a completer and cached after the first run.
+const std::vector<std::string> complete_args{
+    "--__complete", "3", "startup_cli", "-v", "--output", "b"};
+
+/// A build of the reference tool, and the arguments to give it.
+struct Variant {
+  std::string name;
+  std::string path;
+  const std::vector<std::string> &args;
+};
+
+std::vector<Variant> all_variants() {
+  std::vector<Variant> result{{"startup/shared", STARTUP_CLI_SHARED, cli_args}};
+#ifdef STARTUP_CLI_STATIC
+  result.push_back({"startup/static", STARTUP_CLI_STATIC, cli_args});
+#endif
+  result.push_back({"startup/unity", STARTUP_CLI_UNITY, cli_args});
+  result.push_back(
+      {"startup/complete_shared", STARTUP_CLI_SHARED, complete_args});
+  return result;
+}
+
+// Run a variant once, answering its wall time in nanoseconds, or a negative
+// number if it could not be run or failed.
+double run_once(const Variant &variant) {
+  std::vector<char *> argv;
+  argv.push_back(const_cast<char *>(variant.path.c_str()));
+  for (const auto &arg : variant.args) {
+    argv.push_back(const_cast<char *>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  // Discard the tool's output, e.g., completion candidates.
+  posix_spawn_file_actions_t actions;
+  ::posix_spawn_file_actions_init(&actions);
+  ::posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null",
+                                     O_WRONLY, 0);
+
+  using Clock = std::chrono::steady_clock;
+  const auto t0 = Clock::now();
+  pid_t pid = 0;
+  const int spawn_err = ::posix_spawn(&pid, variant.path.c_str(), &actions,
+                                      nullptr, argv.data(), environ);
+  ::posix_spawn_file_actions_destroy(&actions);
+  if (spawn_err != 0) {
+    return -1.0;
+  }
+  int status = 0;
+  if (::waitpid(pid, &status, 0) != pid) {
+    return -1.0;
+  }
+  const auto t1 = Clock::now();
+  if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+    return -1.0;
+  }
+  return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+bool measure(const Variant &variant, double min_seconds,
+             Bench::Measurement &result) {
+  const size_t min_iterations = 10;
+  const size_t max_iterations = 10000;
+
+  // Warm up the page cache, and the completion cache.
+  if (run_once(variant) < 0.0) {
+    return false;
+  }
+
+  std::vector<double> samples;
+  double total_ns = 0.0;
+  while ((samples.size() < min_iterations) ||
+         ((total_ns < min_seconds * 1.0e9) &&
+          (samples.size() < max_iterations))) {
+    const double ns = run_once(variant);
+    if (ns < 0.0) {
+      return false;
+    }
+    samples.push_back(ns);
+    total_ns += ns;
+  }
+
+  std::sort(samples.begin(), samples.end());
+  result.name = variant.name;
+  result.tokens = variant.args.size();
+  result.iterations = samples.size();
+  result.min_ns = samples.front();
+  result.median_ns = samples[samples.size() / 2];
+  result.mean_ns = total_ns / samples.size();
+  return true;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  auto parser = ArgumentParser::create(
+      "Time a reference tool from exec until it has parsed its arguments "
+      "and exited, for each way of linking the library.");
+  auto json_path = option<std::filesystem::path>(
+      parser, "-j", "--json", "Write results as JSON to this file.");
+  auto baseline_path = option<std::filesystem::path>(
+      parser, "-c", "--compare",
+      "Compare results against this JSON baseline.  Exit with status 1 if "
+      "any variant regressed.");
+  auto threshold =
+      option<double>(parser, "-t", "--threshold",
+                     "Allowed slowdown, in percent, before a comparison is "
+                     "reported as a regression.",
+                     10.0);
+  auto min_time = option<double>(
+      parser, "-m", "--min-time", "Minimum seconds to spend per variant.", 1.0);
+
+  parser->parse_args(argc, argv);
+  if (parser->should_exit()) {
+    return parser->exit_code();
+  }
+
+  Bench::Measurements baseline;
+  if (!baseline_path->value().empty()) {
+    std::ifstream ins(baseline_path->value());
+    if (!ins) {
+      std::cerr << "Cannot read baseline " << baseline_path->value()
+                << std::endl;
+      return 2;
+    }
+    baseline = Bench::read_json(ins);
+  }
+
+  Bench::Measurements results;
+  for (const auto &variant : all_variants()) {
+    std::cerr << "Running " << variant.name << "..." << std::endl;
+    Bench::Measurement result;
+    if (!measure(variant, min_time->value(), result)) {
+      std::cerr << "Cannot run " << variant.path << std::endl;
+      return 2;
+    }
+    results.push_back(result);
+  }
+
+  Bench::write_table(std::cout, results);
+
+  if (!json_path->value().empty()) {
+    std::ofstream outs(json_path->value());
+    Bench::write_json(outs, results);
+    if (!outs) {
+      std::cerr << "Cannot write " << json_path->value() << std::endl;
+      return 2;
+    }
+  }
+
+  if (!baseline_path->value().empty()) {
+    std::cout << std::endl;
+    if (Bench::compare(std::cout, baseline, results, threshold->value()) > 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,32 @@
+// A reference command-line tool for bench_startup.  It is built once for
+// each way of linking the library, and does nothing but parse its arguments.
+#include "arg_parse.hpp"
+
+int main(int argc, char *argv[]) {
+  using namespace ArgParse;
+
+  auto parser = ArgumentParser::create("Copy files, as a typical tool might.");
+  auto verbose = flag(parser, "-v", "--verbose", "Report progress.");
+  auto dry_run = flag(parser, "-n", "--dry-run", "Show what would be done.");
+  auto force = flag(parser, "-f", "--force", "Overwrite existing files.");
+  auto output = option<std::string>(parser, "-o", "--output",
+                                    "Where to write the copies.", ".");
+  auto jobs = option<int>(parser, "-j", "--jobs", "How many at once.", 1);
+  auto ratio =
+      option<double>(parser, "-r", "--ratio", "Compression ratio.", 1.0);
+  auto mode = choice(parser, "-m", "--mode", "How to copy.",
+                     {"copy", "link", "move"});
+  auto files = argument<std::string_view>(parser, "files", Nargs::one_or_more,
+                                          "Files to copy.");
+
+  // Stands in for a costly listing, e.g., of a remote's contents.
+  parser->set_completer(
+      output,
+      [] {
+        return std::vector<std::string>{"backup", "build", "release"};
+      },
+      std::chrono::hours(1));
+
+  parser->parse_args(argc, argv);
+  return parser->exit_code();
+}
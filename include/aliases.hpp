@@ -1,5 +1,6 @@
 #pragma once
 
+#include <any>
 #include <deque>
 #include <optional>
 #include <string_view>
@@ -11,4 +12,8 @@ using ArgSeq = std::deque<std::string_view>;
 
 /// An optional error message
 using OptErrMsg = std::optional<std::string>;
+
+/// The per-parse state of one spec, e.g., an option's value, when parsing
+/// into a ParseContext.  Each spec documents the type it stores.
+using SpecState = std::any;
 } // namespace ArgParse
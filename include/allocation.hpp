@@ -0,0 +1,23 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+namespace ArgParse::Internal {
+/**
+ * @brief Create a shared instance of T whose storage, including the shared
+ * pointer's control block, comes from resource.
+ *
+ * @tparam T The type of instance to create
+ * @param resource The memory resource to allocate from
+ * @param args Constructor arguments
+ * @return std::shared_ptr<T> The new instance
+ */
+template <typename T, typename... Args>
+std::shared_ptr<T> make_shared_in(std::pmr::memory_resource *resource,
+                                  Args &&...args) {
+  return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(resource),
+                                 std::forward<Args>(args)...);
+}
+} // namespace ArgParse::Internal
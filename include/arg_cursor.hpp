@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+namespace ArgParse {
+/**
+ * @brief A non-owning cursor over a sequence of command-line arguments.
+ * Specs consume arguments by advancing the cursor; nothing is copied.
+ *
+ * The arguments viewed by a cursor must outlive it.
+ */
+class ArgCursor {
+public:
+  /**
+   * @brief Create a cursor over a sequence of string_views.
+   *
+   * @param args The arguments to traverse
+   */
+  explicit ArgCursor(std::span<const std::string_view> args)
+      : m_views(args.data()), m_size(args.size()) {
+    load_front();
+  }
+
+  /**
+   * @brief Create a cursor over an argv-style array of C strings.
+   *
+   * @param argv The arguments to traverse
+   */
+  explicit ArgCursor(std::span<char *const> argv)
+      : m_argv(argv.data()), m_size(argv.size()) {
+    load_front();
+  }
+
+  /**
+   * @brief Find out whether all arguments have been consumed.
+   */
+  [[nodiscard]] bool empty() const { return m_pos >= m_size; }
+
+  /**
+   * @brief Get the number of arguments not yet consumed.
+   */
+  [[nodiscard]] size_t size() const { return empty() ? 0 : m_size - m_pos; }
+
+  /**
+   * @brief Get the position of the current argument within the whole
+   * sequence.
+   */
+  [[nodiscard]] size_t index() const { return m_pos; }
+
+  /**
+   * @brief Get the current argument.  The cursor must not be empty.
+   */
+  [[nodiscard]] std::string_view front() const { return m_front; }
+
+  /**
+   * @brief Consume the current argument.
+   */
+  void pop_front() {
+    ++m_pos;
+    load_front();
+  }
+
+private:
+  const std::string_view *m_views{nullptr};
+  char *const *m_argv{nullptr};
+  size_t m_size{0};
+  size_t m_pos{0};
+  std::string_view m_front;
+
+  void load_front() {
+    if (empty()) {
+      m_front = {};
+    } else {
+      m_front = m_views ? m_views[m_pos] : std::string_view(m_argv[m_pos]);
+    }
+  }
+};
+} // namespace ArgParse
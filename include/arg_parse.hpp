@@ -3,6 +3,8 @@
 #include "argument.hpp"
 #include "argument_parser.hpp"
 #include "choice.hpp"
+#include "command_line.hpp"
 #include "convenience.hpp"
 #include "flag.hpp"
-#include "option.hpp"
\ No newline at end of file
+#include "option.hpp"
+#include "output_sink.hpp"
\ No newline at end of file
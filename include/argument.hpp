@@ -1,22 +1,37 @@
 #pragma once
 
+#include "allocation.hpp"
 #include "help_fmt.hpp"
 #include "i_argument.hpp"
+#include "parallel_convert.hpp"
 #include "value_converter.hpp"
+#include <functional>
 #include <memory>
+#include <memory_resource>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace ArgParse {
 
 /**
- * @brief Argument describes a type-checked positional argument.
+ * @brief Argument describes a type-checked positional argument.  Its
+ * SpecState holds a std::vector<T>, or for a streaming argument, a count of
+ * values.  While parsing an argument that converts in parallel, it holds the
+ * unconverted tokens.
  *
  * @tparam T The C++ type of the positional argument
  */
 template <typename T> struct Argument : public IArgument {
   using Ptr = std::shared_ptr<Argument<T>>;
+  using value_type = T;
+
+  /// Receives each value of a streaming argument as it is parsed.
+  using Sink = std::function<void(T &&value)>;
+
+  /// The default for convert_in_parallel()
+  static constexpr size_t default_parallel_chunk = 16384;
 
   /**
    * @brief Create a new argument specification.
@@ -25,11 +40,40 @@ template <typename T> struct Argument : public IArgument {
    * @param nargs The number of command-line arguments that can be supplied for
    * this spec, e.g., one, zero or more, one or more
    * @param help_msg A help message describing the meaning of this parameter
+   * @param resource The memory resource from which this argument allocates
+   * its storage, including its values
    * @return Ptr A pointer to the new instance
    */
-  static Ptr create(std::string_view name, Nargs nargs,
-                    std::string_view help_msg) {
-    return std::shared_ptr<Argument>(new Argument(name, nargs, help_msg));
+  static Ptr create(
+      std::string_view name, Nargs nargs, std::string_view help_msg,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+    return Internal::make_shared_in<Created>(resource, name, nargs, help_msg,
+                                             resource, Sink());
+  }
+
+  /**
+   * @brief Create a new argument specification which hands each value to
+   * sink as it is parsed, instead of keeping it.  Memory use does not grow
+   * with the number of values.  values() of a streaming argument is always
+   * empty, but num_values() and is_complete() work as usual.
+   *
+   * When parsing into a ParseContext from several threads, sink is called
+   * from each of them.
+   *
+   * @param name The name of this positional argument, e.g., "filename"
+   * @param nargs The number of command-line arguments that can be supplied for
+   * this spec, e.g., one, zero or more, one or more
+   * @param help_msg A help message describing the meaning of this parameter
+   * @param sink Receives each value
+   * @param resource The memory resource from which this argument allocates
+   * its storage
+   * @return Ptr A pointer to the new instance
+   */
+  static Ptr create_streaming(
+      std::string_view name, Nargs nargs, std::string_view help_msg, Sink sink,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+    return Internal::make_shared_in<Created>(resource, name, nargs, help_msg,
+                                             resource, std::move(sink));
   }
 
   /**
@@ -69,23 +113,85 @@ template <typename T> struct Argument : public IArgument {
    * @return ParseResult An indication of whether this spec consumed any command
    * line arguments; and, if so, whether any errors were encountered
    */
-  ParseResult parse(ArgSeq &args) override {
-    if (args.empty()) {
-      return ParseResult::no_match();
+  ParseResult parse(ArgCursor &args) final {
+    if (m_sink) {
+      SinkValues counted{m_sink, m_num_streamed};
+      return parse_into(args, counted);
+    }
+    if (converts_later()) {
+      return defer(args, m_values.size() + m_pending.size(), m_pending);
     }
+    return parse_into(args, m_values);
+  }
 
-    if ((m_nargs == Nargs::one) && (num_values() > 0)) {
-      return ParseResult::no_match();
+  [[nodiscard]] SpecState initial_state() const override {
+    if (m_sink) {
+      return size_t{0};
+    }
+    if (converts_later()) {
+      return Pending();
     }
+    return std::vector<T>();
+  }
 
-    const std::string strval(args.front());
-    Internal::ValueConverter<T> converter(m_name, strval);
-    args.pop_front();
-    if (converter.m_err_msg) {
-      return ParseResult::match_with_error(converter.m_err_msg.value());
+  ParseResult parse(ArgCursor &args, SpecState &state) const final {
+    if (m_sink) {
+      SinkValues counted{m_sink, std::any_cast<size_t &>(state)};
+      return parse_into(args, counted);
+    }
+    if (converts_later()) {
+      auto &pending = std::any_cast<Pending &>(state).m_tokens;
+      return defer(args, pending.size(), pending);
+    }
+    return parse_into(args, std::any_cast<std::vector<T> &>(state));
+  }
+
+  OptErrMsg finish() override {
+    OptErrMsg result = Internal::convert_all<T>(m_name, m_pending, m_values,
+                                                m_parallel_chunk);
+    m_pending.clear();
+    return result;
+  }
+
+  OptErrMsg finish(SpecState &state) const override {
+    auto *pending = std::any_cast<Pending>(&state);
+    if (!pending) {
+      return {};
+    }
+    std::vector<T> values;
+    OptErrMsg result = Internal::convert_all<T>(m_name, pending->m_tokens,
+                                                values, m_parallel_chunk);
+    state = std::move(values);
+    return result;
+  }
+
+  void discard_pending() override { m_pending.clear(); }
+
+  void discard_pending(SpecState &state) const override {
+    if (std::any_cast<Pending>(&state) != nullptr) {
+      state = std::vector<T>();
     }
-    m_values.push_back(converter.m_value);
-    return ParseResult::match();
+  }
+
+  /**
+   * @brief Convert this argument's values in parallel.  Values are collected
+   * as they are parsed, and converted together once all command-line
+   * arguments have been parsed.  If there are at least twice min_chunk
+   * values, they are converted in chunks of at least min_chunk values on
+   * separate threads.
+   *
+   * The first invalid value is still the one reported.  This has no effect
+   * on streaming arguments.  Call it before parsing.  If parsing stops
+   * early, e.g., because help was requested, the unconverted values are
+   * discarded.  T must be default-constructible, because space for the
+   * converted values is made before they are converted.
+   *
+   * @param min_chunk The fewest values to convert on one thread
+   */
+  void convert_in_parallel(size_t min_chunk = default_parallel_chunk) {
+    static_assert(std::is_default_constructible_v<T>,
+                  "Parallel conversion needs a default-constructible T.");
+    m_parallel_chunk = std::max(min_chunk, size_t{1});
   }
 
   /**
@@ -95,7 +201,19 @@ template <typename T> struct Argument : public IArgument {
    * @return std::vector<T> The sequence of command-line arguments matched by
    * this spec
    */
-  [[nodiscard]] std::vector<T> values() const { return m_values; }
+  [[nodiscard]] std::vector<T> values() const {
+    return {m_values.begin(), m_values.end()};
+  }
+
+  /**
+   * @brief Discard any values parsed for this argument, keeping the storage
+   * that held them.
+   */
+  void reset() override {
+    m_values.clear();
+    m_pending.clear();
+    m_num_streamed = 0;
+  }
 
   /**
    * @brief Call this after calling parse, to find out whether this spec found
@@ -105,15 +223,7 @@ template <typename T> struct Argument : public IArgument {
    * @return false If it did not
    */
   [[nodiscard]] bool is_complete() const override {
-    switch (m_nargs) {
-    case Nargs::one:
-      return m_values.size() == 1;
-    case Nargs::zero_or_more:
-      return true;
-    case Nargs::one_or_more:
-      return m_values.size() > 0;
-    }
-    return false;
+    return Internal::nargs_satisfied(m_nargs, num_values());
   }
 
   /**
@@ -123,16 +233,110 @@ template <typename T> struct Argument : public IArgument {
    *
    * @return size_t The number of command-line arguments matched by this spec.
    */
-  [[nodiscard]] size_t num_values() const override { return m_values.size(); }
+  [[nodiscard]] size_t num_values() const override {
+    return m_sink ? m_num_streamed : (m_values.size() + m_pending.size());
+  }
+
+  [[nodiscard]] size_t num_values(const SpecState &state) const override {
+    if (m_sink) {
+      return std::any_cast<size_t>(state);
+    }
+    if (const auto *pending = std::any_cast<Pending>(&state)) {
+      return pending->m_tokens.size();
+    }
+    return std::any_cast<const std::vector<T> &>(state).size();
+  }
+
+  [[nodiscard]] Internal::ArgumentDispatch dispatch() override {
+    return {this, &dispatch_parse, &dispatch_parse_state};
+  }
 
 protected:
-  Argument(std::string_view name, Nargs nargs, std::string_view help_msg)
-      : m_name(name), m_nargs(nargs), m_help_msg(help_msg) {}
+  Argument(std::string_view name, Nargs nargs, std::string_view help_msg,
+           std::pmr::memory_resource *resource, Sink sink = {})
+      : m_name(name, resource), m_nargs(nargs), m_help_msg(help_msg, resource),
+        m_values(resource), m_sink(std::move(sink)), m_pending(resource) {}
 
 private:
-  const std::string m_name;
+  const std::pmr::string m_name;
   const Nargs m_nargs;
-  const std::string m_help_msg;
-  std::vector<T> m_values;
+  const std::pmr::string m_help_msg;
+  std::pmr::vector<T> m_values;
+  const Sink m_sink;
+  size_t m_num_streamed{0};
+  // Non-zero if values are converted in parallel, after parsing.
+  size_t m_parallel_chunk{0};
+  // Tokens parsed but not yet converted.
+  std::pmr::vector<std::string_view> m_pending;
+
+  struct Created;
+
+  // parse is final, so these calls are not virtual.
+  static ParseResult dispatch_parse(void *self, ArgCursor &args) {
+    return static_cast<Argument<T> *>(self)->parse(args);
+  }
+
+  static ParseResult dispatch_parse_state(const void *self, ArgCursor &args,
+                                          SpecState &state) {
+    return static_cast<const Argument<T> *>(self)->parse(args, state);
+  }
+
+  // The state of an argument which converts in parallel, while parsing into
+  // a ParseContext.
+  struct Pending {
+    std::vector<std::string_view> m_tokens;
+  };
+
+  [[nodiscard]] bool converts_later() const {
+    return (m_parallel_chunk > 0) && !m_sink;
+  }
+
+  template <typename Tokens>
+  ParseResult defer(ArgCursor &args, size_t num_values, Tokens &tokens) const {
+    if (args.empty() || ((m_nargs == Nargs::one) && (num_values > 0))) {
+      return ParseResult::no_match();
+    }
+    tokens.push_back(args.front());
+    args.pop_front();
+    return ParseResult::match();
+  }
+
+  // Lets parse_into hand values to a sink as if it were a container.
+  struct SinkValues {
+    const Sink &m_sink;
+    size_t &m_count;
+
+    [[nodiscard]] bool empty() const { return m_count == 0; }
+
+    void push_back(T &&value) {
+      m_sink(std::move(value));
+      ++m_count;
+    }
+  };
+
+  template <typename Values>
+  ParseResult parse_into(ArgCursor &args, Values &values) const {
+    if (args.empty()) {
+      return ParseResult::no_match();
+    }
+
+    if ((m_nargs == Nargs::one) && !values.empty()) {
+      return ParseResult::no_match();
+    }
+
+    Internal::ValueConverter<T> converter(m_name, args.front());
+    args.pop_front();
+    if (converter.failed()) {
+      return converter.as_parse_result();
+    }
+    values.push_back(std::move(converter.m_value));
+    return ParseResult::match();
+  }
+};
+
+// Makes the protected constructor available to make_shared_in.
+template <typename T> struct Argument<T>::Created : public Argument<T> {
+  template <typename... Args>
+  Created(Args &&...args) : Argument<T>(std::forward<Args>(args)...) {}
 };
 } // namespace ArgParse
\ No newline at end of file
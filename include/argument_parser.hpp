@@ -1,11 +1,19 @@
 #pragma once
 
 #include "aliases.hpp"
+#include "arg_cursor.hpp"
 #include "flag.hpp"
 #include "i_argument.hpp"
 #include "i_option.hpp"
+#include "output_sink.hpp"
+#include "parse_context.hpp"
+#include <chrono>
+#include <functional>
+#include <memory_resource>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 /**
  * @brief Top-level namespace for this library.
@@ -19,19 +27,40 @@ namespace ArgParse {
 struct ArgumentParser {
   using Ptr = std::shared_ptr<ArgumentParser>;
 
+  /// Adds the options and arguments of a subcommand to its parser.
+  using SubcommandFactory = std::function<void(Ptr subparser)>;
+
+  /// Lists every value that an option accepts, for shell completion.
+  using Completer = std::function<std::vector<std::string>()>;
+
   /**
    * @brief Create a new instance.
    *
    * @param description Describes the purpose of the program that's parsing the
    * command line.
+   * @param resource The memory resource from which the parser allocates its
+   * storage.  Pass the same resource when creating specs for the parser, or
+   * use the convenience functions such as flag() and option(), to keep all of
+   * a parser's allocations in one arena.
    * @return Ptr Pointer to a new instance.
    */
-  static Ptr create(std::string_view description);
+  static Ptr
+  create(std::string_view description,
+         std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+  /**
+   * @brief Get the memory resource from which this parser allocates.
+   *
+   * @return std::pmr::memory_resource* The parser's memory resource
+   */
+  [[nodiscard]] virtual std::pmr::memory_resource *resource() const = 0;
 
   /**
    * @brief Add an Option or a Flag.
    *
    * @param option An option (-o|--output FILENAME) or a flag (-v|--verbose)
+   * @throws std::invalid_argument if the option's short or long name is
+   * already used by another option of this parser
    */
   virtual void add_option(IOption::Ptr option) = 0;
 
@@ -39,11 +68,149 @@ struct ArgumentParser {
    * @brief Add a positional argument, e.g., a required filename.
    *
    * @param arg A positional argument
+   * @throws std::invalid_argument if this parser has subcommands
    */
   virtual void add_arg(IArgument::Ptr arg) = 0;
 
+  /**
+   * @brief Add a subcommand, e.g., the "commit" of "git commit".
+   *
+   * The first positional argument of a parser with subcommands names the
+   * subcommand.  Only that subcommand's parser is built, by calling factory
+   * with a new parser, and only when the subcommand is first invoked.  The
+   * remaining arguments are parsed by that parser.  Help for this parser
+   * lists each subcommand's summary without building any subcommand.
+   *
+   * A parser with subcommands can't have positional arguments of its own,
+   * and can't be compiled.
+   *
+   * @param name The name of the subcommand
+   * @param summary A one-line description of the subcommand.  This is also
+   * the description of the subcommand's parser.
+   * @param factory Adds the subcommand's options and arguments to its parser
+   * @throws std::invalid_argument if name is already used by another
+   * subcommand, or if this parser has positional arguments
+   */
+  virtual void add_subcommand(std::string_view name, std::string_view summary,
+                              SubcommandFactory factory) = 0;
+
+  /**
+   * @brief Get the name of the subcommand that was invoked.  Call this after
+   * calling parse_args.
+   *
+   * @return std::string_view The subcommand's name, or an empty string if no
+   * subcommand was invoked
+   */
+  [[nodiscard]] virtual std::string_view subcommand() const = 0;
+
+  /**
+   * @brief Get the parser of the subcommand that was invoked.  Call this
+   * after calling parse_args.
+   *
+   * @return Ptr The subcommand's parser, or nullptr if no subcommand was
+   * invoked
+   */
+  [[nodiscard]] virtual Ptr subparser() const = 0;
+
+  /**
+   * @brief Offer shell completion of an option's values from a function,
+   * e.g., one that lists the branches of a repository.
+   *
+   * Shell completion scripts invoke the program as
+   * `program --__complete CWORD WORD...`, where the WORDs are the command
+   * line being edited, starting with the program's name, and word CWORD is
+   * the one being completed.  parse_args then writes the candidates that
+   * start with that word, one per line, to the output sink, and recommends
+   * exit code 0.  Candidates are option names, subcommand names and option
+   * values: the choices of a Choice, or those listed by its completer.
+   *
+   * Completer results are cached under $XDG_CACHE_HOME/arg_parse, or
+   * $HOME/.cache/arg_parse, so that repeated completions don't call the
+   * completer.  A cached list is discarded once it is older than max_age,
+   * or once the program's executable changes.
+   *
+   * @param option An option of this parser
+   * @param completer Lists the option's values
+   * @param max_age How long to cache the list, or 0 not to cache it
+   * @throws std::invalid_argument if option has not been added to this
+   * parser
+   */
+  virtual void set_completer(const IOption::Ptr &option, Completer completer,
+                             std::chrono::seconds max_age) = 0;
+
+  /**
+   * @brief Expand "@path" arguments into the arguments contained in the file
+   * at path.  This is off by default.
+   *
+   * A response file holds arguments separated by whitespace.  An argument
+   * wrapped in single or double quotes may contain whitespace; the quotes are
+   * removed, and no escape sequences are interpreted.  Response files may
+   * name other response files.  Files are memory-mapped, and their arguments
+   * are not copied.
+   */
+  virtual void enable_response_files() = 0;
+
+  /**
+   * @brief Take the values of options not given on the command line from a
+   * config file.  Any previously loaded config file is replaced.
+   *
+   * The file holds "key = value" lines, optionally grouped into sections
+   * such as "[commit]", in a subset of INI and TOML; blank lines and lines
+   * starting with '#' or ';' are ignored.  The key of an option is its long
+   * name without the leading dashes, e.g., "output" for "--output".  This
+   * parser reads the keys that precede every section header; each
+   * subcommand's parser reads the section named after its subcommand, e.g.,
+   * "[remote.add]" for "git remote add".  Keys that name no option are
+   * ignored.  A flag's value is 0, 1, true or false.
+   *
+   * Values are converted as if given on the command line, which overrides
+   * them, as does an option's environment variable.  The file is
+   * memory-mapped, and its keys and values are not copied.
+   *
+   * @param path The path of the config file
+   * @return OptErrMsg A description of the failure, if the file could not
+   * be read or is malformed.  The parser is then unchanged.
+   */
+  virtual OptErrMsg load_config(std::string_view path) = 0;
+
+  /**
+   * @brief Send help and error messages to a sink instead of to std::cout
+   * and std::cerr.  Subcommands' parsers use the same sink, as do compiled
+   * snapshots taken afterwards.
+   *
+   * @param sink Receives help and error messages.  Help text is wrapped to
+   * its width.
+   */
+  virtual void set_output(OutputSink::Ptr sink) = 0;
+
+  /**
+   * @brief Take an immutable snapshot of this parser's specs, for parsing
+   * from several threads at once.  Options and arguments added to this
+   * parser afterwards are not seen by the snapshot.
+   *
+   * The snapshot copies the specs' names, initial values and environment
+   * variables, but parses through the specs themselves.  Don't otherwise
+   * change a spec, e.g., with convert_in_parallel(), while a snapshot of it
+   * is in use.
+   *
+   * @return CompiledParser::Ptr The snapshot.  It allocates from this
+   * parser's memory resource.
+   * @throws std::invalid_argument if this parser has subcommands
+   */
+  [[nodiscard]] virtual CompiledParser::Ptr compile() const = 0;
+
+  /**
+   * @brief Parse a sequence of command-line arguments.  The arguments are
+   * not copied.
+   *
+   * @param args Arguments to parse
+   */
+  virtual void parse_args(std::span<const std::string_view> args) = 0;
+
   /**
    * @brief Parse a sequence of command-line arguments.
+   * This overload is kept for compatibility.  It copies args into a
+   * contiguous buffer before parsing them.
    *
    * @param args Arguments to parse
    */
@@ -51,13 +218,21 @@ struct ArgumentParser {
 
   /**
    * @brief Parse a sequence of command-line arguments.
-   * This overload eases use from `int main(int argc, char *argv[])`.
+   * This overload eases use from `int main(int argc, char *argv[])`.  The
+   * arguments are not copied.
    *
    * @param argc The number of command-line arguments
    * @param argv Array of command-line arguments
    */
   virtual void parse_args(int argc, char *argv[]) = 0;
 
+  /**
+   * @brief Restore the parser and all of its specs to their state before any
+   * arguments were parsed, so that the parser can be reused.  Storage
+   * allocated by previous parses is kept for reuse.
+   */
+  virtual void reset() = 0;
+
   /**
    * @brief Find out whether or not the program should exit due to invalid
    * command-line arguments. Call this after calling parse_args.
@@ -78,7 +253,8 @@ struct ArgumentParser {
   [[nodiscard]] virtual int exit_code() const = 0;
 
   /**
-   * @brief Print a parse error message to cerr, followed by usage.
+   * @brief Print a parse error message, followed by usage, to this parser's
+   * output sink.
    *
    * @param msg The error message to print
    * @param exit_code The recommended exit code for this error
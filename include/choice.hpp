@@ -1,10 +1,77 @@
 #pragma once
 
+#include "allocation.hpp"
+#include "help_fmt.hpp"
 #include "option.hpp"
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace ArgParse {
+
+namespace Internal {
+/**
+ * @brief The valid values of a choice, matched regardless of case.  This is
+ * for internal use.
+ *
+ * The values are case-folded once, when the table is built, and kept sorted,
+ * so that matching a value takes a binary search and no allocation.
+ */
+class ChoiceTable {
+public:
+  /**
+   * @brief Build a table.
+   *
+   * @param names The valid values
+   * @param resource The memory resource from which the table allocates
+   */
+  ChoiceTable(const std::vector<std::string_view> &names,
+              std::pmr::memory_resource *resource);
+
+  /**
+   * @brief Find a value, regardless of case.
+   *
+   * @param value The value to find
+   * @return std::optional<size_t> The index, in the list from which the
+   * table was built, of the first name that matches value; or nothing if
+   * none does
+   */
+  [[nodiscard]] std::optional<size_t> find(std::string_view value) const;
+
+  /// The valid values, as given.
+  [[nodiscard]] const std::pmr::vector<std::pmr::string> &names() const {
+    return m_names;
+  }
+
+private:
+  // Locates a folded name within m_folded.
+  struct Entry {
+    uint32_t offset;
+    uint32_t size;
+    size_t index;
+  };
+
+  std::pmr::vector<std::pmr::string> m_names;
+  // Every name, case-folded, end to end.
+  std::pmr::string m_folded;
+  // Sorted by folded name, then by index.
+  std::pmr::vector<Entry> m_sorted;
+
+  [[nodiscard]] std::string_view folded(const Entry &entry) const {
+    return std::string_view(m_folded).substr(entry.offset, entry.size);
+  }
+};
+} // namespace Internal
+
+/**
+ * @brief An option whose value must be one of a list of strings, matched
+ * regardless of case.  Its SpecState holds a std::string.
+ */
 struct Choice : public Option<std::string> {
   using Ptr = std::shared_ptr<Choice>;
 
@@ -13,14 +80,187 @@ struct Choice : public Option<std::string> {
   Choice &operator=(const Choice &src) = delete;
   Choice &operator=(Choice &&src) = delete;
 
-  static Ptr create(std::string_view short_name, std::string_view long_name,
-                    std::string_view help_msg,
-                    const std::vector<std::string> &valid_choices);
+  static Ptr create(
+      std::string_view short_name, std::string_view long_name,
+      std::string_view help_msg, const std::vector<std::string> &valid_choices,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+  [[nodiscard]] Internal::OptionDispatch dispatch() override {
+    Internal::OptionDispatch result = Option<std::string>::dispatch();
+    result.kind = Internal::OptionKind::choice;
+    return result;
+  }
 
 protected:
   Choice(std::string_view short_name, std::string_view long_name,
-         std::string_view help_msg, std::string_view default_choice)
+         std::string_view help_msg, std::string_view default_choice,
+         std::pmr::memory_resource *resource)
       : Option<std::string>(short_name, long_name, help_msg,
-                            std::string(default_choice)) {}
+                            std::string(default_choice), resource) {}
+};
+
+/**
+ * @brief An option whose value is chosen by name from a list, e.g., an
+ * enumerator, or the index of the name.  Names are matched regardless of
+ * case.  Its SpecState holds an E.
+ *
+ * @tparam E The type of value associated with each name
+ */
+template <typename E> struct EnumChoice : public IOption {
+  using Ptr = std::shared_ptr<EnumChoice<E>>;
+  using value_type = E;
+  /// Each valid name, and the value it stands for.
+  using Choices = std::vector<std::pair<std::string_view, E>>;
+
+  EnumChoice(const EnumChoice &src) = delete;
+  EnumChoice(EnumChoice &&src) = delete;
+  EnumChoice &operator=(const EnumChoice &src) = delete;
+  EnumChoice &operator=(EnumChoice &&src) = delete;
+
+  /**
+   * @brief Create a new choice.  Its default value is that of the first
+   * choice.
+   *
+   * @param short_name The short name of the option, e.g., "-m"
+   * @param long_name The long name of the option, e.g., "--mode"
+   * @param help_msg A description of the purpose of this option
+   * @param choices Each valid name, and the value it stands for
+   * @param resource The memory resource from which this option allocates
+   * its storage
+   * @return Ptr A pointer to the created instance
+   * @throws std::invalid_argument if choices is empty
+   */
+  static Ptr create(
+      std::string_view short_name, std::string_view long_name,
+      std::string_view help_msg, const Choices &choices,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+    if (choices.empty()) {
+      throw std::invalid_argument("At least one choice must be specified.");
+    }
+    return Internal::make_shared_in<Created>(resource, short_name, long_name,
+                                             help_msg, choices, resource);
+  }
+
+  /**
+   * @brief Get the value of this option.  Call this after calling parse on
+   * the ArgumentParser to which this option has been added.
+   *
+   * @return E The value of the chosen name
+   */
+  [[nodiscard]] E value() const { return m_value; }
+
+  [[nodiscard]] std::string usage() const override {
+    return Internal::option_usage_str(m_short, m_long);
+  }
+
+  [[nodiscard]] std::string help() const override {
+    return Internal::option_help_block(
+        m_short, m_long,
+        Internal::env_help_msg(
+            Internal::choice_help_msg(m_help_msg, m_table.names()),
+            m_env_var));
+  }
+
+  [[nodiscard]] std::string_view short_name() const override {
+    return m_short;
+  }
+
+  [[nodiscard]] std::string_view long_name() const override { return m_long; }
+
+  [[nodiscard]] bool takes_value() const override { return true; }
+
+  [[nodiscard]] std::vector<std::string> value_candidates() const override {
+    return {m_table.names().begin(), m_table.names().end()};
+  }
+
+  [[nodiscard]] SpecState initial_state() const override { return m_default; }
+
+  void set_env_var(std::string_view name) override { m_env_var = name; }
+
+  [[nodiscard]] std::string_view env_var() const override { return m_env_var; }
+
+  ParseResult parse_value(std::string_view source,
+                          std::string_view value) final {
+    return set_value(source, value, m_value);
+  }
+
+  ParseResult parse_value(std::string_view source, std::string_view value,
+                          SpecState &state) const final {
+    return set_value(source, value, std::any_cast<E &>(state));
+  }
+
+  void reset() override { m_value = m_default; }
+
+  [[nodiscard]] Internal::OptionDispatch dispatch() override {
+    return {Internal::OptionKind::choice, this, &dispatch_parse_value,
+            &dispatch_parse_state};
+  }
+
+protected:
+  EnumChoice(std::string_view short_name, std::string_view long_name,
+             std::string_view help_msg, const Choices &choices,
+             std::pmr::memory_resource *resource)
+      : m_short(short_name, resource), m_long(long_name, resource),
+        m_help_msg(help_msg, resource), m_env_var(resource),
+        m_table(names_of(choices), resource), m_values(resource),
+        m_default(choices.front().second), m_value(m_default) {
+    m_values.reserve(choices.size());
+    for (const auto &choice : choices) {
+      m_values.push_back(choice.second);
+    }
+  }
+
+private:
+  struct Created;
+
+  const std::pmr::string m_short;
+  const std::pmr::string m_long;
+  const std::pmr::string m_help_msg;
+  std::pmr::string m_env_var;
+  const Internal::ChoiceTable m_table;
+  // The value of each name, in the order given.
+  std::pmr::vector<E> m_values;
+  const E m_default;
+  E m_value;
+
+  static ParseResult dispatch_parse_value(void *self, std::string_view source,
+                                          std::string_view value) {
+    auto *choice = static_cast<EnumChoice<E> *>(self);
+    return choice->set_value(source, value, choice->m_value);
+  }
+
+  static ParseResult dispatch_parse_state(const void *self,
+                                          std::string_view source,
+                                          std::string_view value,
+                                          SpecState &state) {
+    return static_cast<const EnumChoice<E> *>(self)->set_value(
+        source, value, std::any_cast<E &>(state));
+  }
+
+  static std::vector<std::string_view> names_of(const Choices &choices) {
+    std::vector<std::string_view> result;
+    result.reserve(choices.size());
+    for (const auto &choice : choices) {
+      result.push_back(choice.first);
+    }
+    return result;
+  }
+
+  ParseResult set_value(std::string_view name, std::string_view sval,
+                        E &dest) const {
+    const auto index = m_table.find(sval);
+    if (!index) {
+      return ParseResult::match_with_error(ParseError::invalid_value, name,
+                                           sval);
+    }
+    dest = m_values[*index];
+    return ParseResult::match();
+  }
+};
+
+// Makes the protected constructor available to make_shared_in.
+template <typename E> struct EnumChoice<E>::Created : public EnumChoice<E> {
+  template <typename... Args>
+  Created(Args &&...args) : EnumChoice<E>(std::forward<Args>(args)...) {}
 };
 } // namespace ArgParse
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace ArgParse {
+/**
+ * @brief A command line split into arguments, following POSIX shell quoting
+ * rules.
+ *
+ * Arguments are separated by unquoted spaces, tabs and newlines.  Text within
+ * single quotes is taken literally.  Within double quotes, a backslash
+ * escapes only $, `, ", \ and newline.  Elsewhere, a backslash escapes any
+ * character, and a backslash-newline pair is removed.  Adjacent quoted and
+ * unquoted text forms a single argument.  No expansions of any kind are
+ * performed.
+ *
+ * Arguments that need no unescaping view the original line, which must
+ * outlive this instance.  Others view storage owned by this instance.
+ *
+ * A CommandLine converts to a span of arguments, so it can be passed
+ * straight to ArgumentParser::parse_args.  The first argument is taken to be
+ * the command name.
+ */
+class CommandLine {
+public:
+  CommandLine() = default;
+
+  /**
+   * @brief Split a command line.
+   *
+   * @param line The command line to split
+   * @throws std::invalid_argument if the line has an unterminated quote
+   */
+  explicit CommandLine(std::string_view line) { assign(line); }
+
+  /**
+   * @brief Split another command line, reusing this instance's storage.
+   *
+   * @param line The command line to split
+   * @throws std::invalid_argument if the line has an unterminated quote
+   */
+  void assign(std::string_view line);
+
+  /**
+   * @brief Get the arguments.
+   */
+  [[nodiscard]] std::span<const std::string_view> args() const {
+    return m_args;
+  }
+
+  operator std::span<const std::string_view>() const { return m_args; }
+
+private:
+  std::vector<std::string_view> m_args;
+  // Holds unescaped arguments.  Unescaping never lengthens text, so this
+  // never needs more room than the line itself.
+  std::unique_ptr<char[]> m_unescaped;
+  size_t m_capacity{0};
+};
+
+/**
+ * @brief Split a command line into arguments, following POSIX shell quoting
+ * rules.  See CommandLine.
+ *
+ * @param line The command line to split
+ * @return CommandLine The arguments
+ * @throws std::invalid_argument if the line has an unterminated quote
+ */
+inline CommandLine split_command_line(std::string_view line) {
+  return CommandLine(line);
+}
+} // namespace ArgParse
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ArgParse::Internal {
+/**
+ * @brief Stores the shell-completion candidates of options across runs of a
+ * program.  This is for internal use.
+ *
+ * Each entry is a small file.  An entry is used only while it is younger than
+ * the age its reader allows, and only by the build of the program that wrote
+ * it: rebuilding or reinstalling the program invalidates every entry.
+ * Failures to read or write entries are ignored; the cache is only an
+ * optimization.
+ */
+class CompletionCache {
+public:
+  /**
+   * @brief Create a cache.
+   *
+   * @param directory Where to store entries, or an empty path to store none
+   * @param fingerprint Identifies the build of the program, e.g., by the
+   * size and modification time of its executable
+   */
+  CompletionCache(std::filesystem::path directory, std::string fingerprint);
+
+  /**
+   * @brief Get the cache of the running program, in
+   * $XDG_CACHE_HOME/arg_parse or, failing that, in $HOME/.cache/arg_parse.
+   * It stores nothing if neither variable is set.
+   *
+   * @return CompletionCache The cache
+   */
+  static CompletionCache standard();
+
+  /**
+   * @brief Get the candidates stored under a key.
+   *
+   * @param key Identifies the candidates, e.g., by program and option name
+   * @param max_age The greatest age of entry to use
+   * @return std::optional<std::vector<std::string>> The candidates, or
+   * nothing if no valid entry is stored
+   */
+  [[nodiscard]] std::optional<std::vector<std::string>>
+  load(std::string_view key, std::chrono::seconds max_age) const;
+
+  /**
+   * @brief Store candidates under a key, replacing any previous entry.
+   *
+   * @param key Identifies the candidates
+   * @param candidates The candidates.  Any containing a newline are omitted.
+   */
+  void store(std::string_view key,
+             const std::vector<std::string> &candidates) const;
+
+private:
+  std::filesystem::path m_directory;
+  std::string m_fingerprint;
+
+  [[nodiscard]] std::filesystem::path entry_path(std::string_view key) const;
+};
+} // namespace ArgParse::Internal
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "aliases.hpp"
+#include "response_file.hpp"
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ArgParse::Internal {
+/**
+ * @brief The keys and values of a configuration file, in a subset of INI and
+ * TOML.  This is for internal use.
+ *
+ * Each line is blank, a comment starting with '#' or ';', a section header
+ * such as "[server]", or a "key = value" pair.  A value wrapped in single or
+ * double quotes may contain '#' and surrounding whitespace; the quotes are
+ * removed, and no escape sequences are interpreted.  An unquoted value ends
+ * at a '#' preceded by whitespace.  Where a key appears more than once in a
+ * section, the last occurrence wins.
+ *
+ * Files are memory-mapped, and neither keys nor values are copied.  The
+ * index is an array of views into the mapping plus an open-addressing hash
+ * table of positions in that array, so it takes two allocations however
+ * many keys there are.
+ */
+class ConfigFile {
+public:
+  explicit ConfigFile(
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : m_entries(resource), m_slots(resource) {}
+
+  /**
+   * @brief Map and index a file, discarding anything previously indexed.
+   *
+   * @param path The path of the file
+   * @return OptErrMsg A description of the failure, if the file could not
+   * be read or is malformed
+   */
+  OptErrMsg load(std::string_view path);
+
+  /**
+   * @brief Index text held by the caller, discarding anything previously
+   * indexed.  The text must outlive this instance.
+   *
+   * @param contents The text to index
+   * @param name Identifies the text in error messages, e.g., a path
+   * @return OptErrMsg A description of the failure, if the text is malformed
+   */
+  OptErrMsg parse(std::string_view contents, std::string_view name);
+
+  /**
+   * @brief Get the value of a key.
+   *
+   * @param section The section of the key, or an empty string for keys that
+   * precede every section header
+   * @param key The name of the key
+   * @return std::optional<std::string_view> Its value, or nothing if the key
+   * is absent
+   */
+  [[nodiscard]] std::optional<std::string_view>
+  find(std::string_view section, std::string_view key) const;
+
+  /// The number of distinct keys, across all sections.
+  [[nodiscard]] size_t size() const { return m_entries.size(); }
+
+private:
+  struct Entry {
+    std::string_view section;
+    std::string_view key;
+    std::string_view value;
+  };
+
+  std::optional<MappedFile> m_file;
+  // Distinct keys, in the order in which they first appear.
+  std::pmr::vector<Entry> m_entries;
+  // Each slot holds 1 + the index of an entry, or 0 if it is empty.
+  std::pmr::vector<uint32_t> m_slots;
+
+  static size_t hash_section(std::string_view section);
+
+  // Find the slot of a key, or the empty slot where it belongs.
+  [[nodiscard]] size_t find_slot(std::string_view section,
+                                 std::string_view key,
+                                 size_t section_hash) const;
+
+  void insert(const Entry &entry, size_t section_hash);
+};
+} // namespace ArgParse::Internal
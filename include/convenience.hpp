@@ -9,6 +9,9 @@
 
 namespace ArgParse {
 
+// Each of these creates its spec in the parser's memory resource.  They are
+// inline, so this header may be included by any number of translation units.
+
 /**
  * @brief Add a new Flag to an ArgumentParser.
  *
@@ -18,9 +21,10 @@ namespace ArgParse {
  * @param help_msg A description of the purpose of the Flag
  * @return Flag::Ptr The new Flag
  */
-Flag::Ptr flag(ArgumentParser::Ptr parser, std::string_view short_name,
-               std::string_view long_name, std::string_view help_msg) {
-  auto result = Flag::create(short_name, long_name, help_msg);
+inline Flag::Ptr flag(ArgumentParser::Ptr parser, std::string_view short_name,
+                      std::string_view long_name, std::string_view help_msg) {
+  auto result =
+      Flag::create(short_name, long_name, help_msg, parser->resource());
   parser->add_option(result);
   return result;
 }
@@ -40,8 +44,8 @@ template <typename T>
 auto option(ArgumentParser::Ptr parser, std::string_view short_name,
             std::string_view long_name, std::string_view help_msg,
             const T default_value = {}) {
-  auto result =
-      Option<T>::create(short_name, long_name, help_msg, default_value);
+  auto result = Option<T>::create(short_name, long_name, help_msg,
+                                  default_value, parser->resource());
   parser->add_option(result);
   return result;
 }
@@ -56,10 +60,34 @@ auto option(ArgumentParser::Ptr parser, std::string_view short_name,
  * @param  choices     Valid values for the Choice
  * @return  The new Choice
  */
-Choice::Ptr choice(ArgumentParser::Ptr parser, std::string_view short_name,
-                   std::string_view long_name, std::string_view help_msg,
-                   const std::vector<std::string> &choices) {
-  auto result = Choice::create(short_name, long_name, help_msg, choices);
+inline Choice::Ptr choice(ArgumentParser::Ptr parser,
+                          std::string_view short_name,
+                          std::string_view long_name,
+                          std::string_view help_msg,
+                          const std::vector<std::string> &choices) {
+  auto result = Choice::create(short_name, long_name, help_msg, choices,
+                               parser->resource());
+  parser->add_option(result);
+  return result;
+}
+
+/**
+ * @brief Add a new EnumChoice to an ArgumentParser.
+ *
+ * @tparam E The type of value associated with each name
+ * @param parser The Parser to which to add the EnumChoice
+ * @param short_name The short, single-dash name of the EnumChoice ("-m")
+ * @param long_name The long, double-dash name of the EnumChoice ("--mode")
+ * @param help_msg A description of the purpose of the EnumChoice
+ * @param choices Each valid name, and the value it stands for
+ * @return auto The new EnumChoice
+ */
+template <typename E>
+auto enum_choice(ArgumentParser::Ptr parser, std::string_view short_name,
+                 std::string_view long_name, std::string_view help_msg,
+                 const typename EnumChoice<E>::Choices &choices) {
+  auto result = EnumChoice<E>::create(short_name, long_name, help_msg, choices,
+                                      parser->resource());
   parser->add_option(result);
   return result;
 }
@@ -77,7 +105,31 @@ Choice::Ptr choice(ArgumentParser::Ptr parser, std::string_view short_name,
 template <typename T>
 auto argument(ArgumentParser::Ptr parser, std::string_view name, Nargs nargs,
               std::string_view help_msg) {
-  auto result = Argument<T>::create(name, nargs, help_msg);
+  auto result =
+      Argument<T>::create(name, nargs, help_msg, parser->resource());
+  parser->add_arg(result);
+  return result;
+}
+
+/**
+ * @brief Add a new streaming Argument to an ArgumentParser.  Each value is
+ * handed to sink as it is parsed, instead of being kept.
+ *
+ * @tparam T The type of value(s) held by the Argument
+ * @param parser The Parser to which to add the Argument
+ * @param name The Argument's name
+ * @param nargs The number of values the Argument can accept
+ * @param help_msg A description of the purpose of the Argument
+ * @param sink Receives each value
+ * @return auto The new Argument
+ */
+template <typename T>
+auto streaming_argument(ArgumentParser::Ptr parser, std::string_view name,
+                        Nargs nargs, std::string_view help_msg,
+                        typename Argument<T>::Sink sink) {
+  auto result = Argument<T>::create_streaming(name, nargs, help_msg,
+                                              std::move(sink),
+                                              parser->resource());
   parser->add_arg(result);
   return result;
 }
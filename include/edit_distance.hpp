@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace ArgParse::Internal {
+/**
+ * @brief Measures the Levenshtein distance from one string, the pattern, to
+ * others.  This is for internal use.
+ *
+ * This is Myers' bit-parallel algorithm, as Hyyrö adapted it to whole-string
+ * distance: a column of the distance matrix is kept as two bit vectors, and
+ * each character of the other string advances it with a dozen word
+ * operations.  Patterns may be at most max_size characters long.
+ */
+class EditDistance {
+public:
+  /// The length of the longest pattern.
+  static constexpr size_t max_size = 64;
+
+  /**
+   * @brief Prepare to measure distances from a pattern.
+   *
+   * @param pattern The pattern, of at most max_size characters
+   */
+  explicit EditDistance(std::string_view pattern);
+
+  /**
+   * @brief Measure the distance from the pattern to a string, giving up once
+   * it must exceed a limit.
+   *
+   * @param text The string
+   * @param max_distance The limit
+   * @return std::optional<size_t> The distance, or nothing if it exceeds
+   * max_distance
+   */
+  [[nodiscard]] std::optional<size_t> to(std::string_view text,
+                                         size_t max_distance) const;
+
+private:
+  // For each character, the positions in the pattern where it occurs.
+  std::array<uint64_t, 256> m_positions{};
+  size_t m_size;
+};
+
+/**
+ * @brief Find the names nearest to a mistyped one.
+ *
+ * @param name The mistyped name
+ * @param candidates The names it may have been meant to be
+ * @param max_distance The greatest edit distance to consider
+ * @return std::vector<std::string_view> The candidates at the least distance
+ * from name, if it is at most max_distance, sorted.  Empty if name is longer
+ * than EditDistance::max_size.
+ */
+std::vector<std::string_view>
+nearest_names(std::string_view name,
+              std::span<const std::string_view> candidates,
+              size_t max_distance);
+} // namespace ArgParse::Internal
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace ArgParse::Internal {
+/**
+ * @brief A snapshot of environment variables, indexed by name.  This is for
+ * internal use.
+ *
+ * Looking up many variables with getenv scans the environment once per
+ * lookup.  An EnvIndex scans it once, copying every variable, so later
+ * changes to the environment don't invalidate it.
+ */
+class EnvIndex {
+public:
+  /**
+   * @brief Index an environ-style array of "NAME=value" strings.  Where a
+   * name appears more than once, the first occurrence wins, as with getenv.
+   *
+   * @param envp A null-terminated array of variables
+   * @param resource The memory resource from which to allocate the snapshot
+   */
+  explicit EnvIndex(
+      const char *const *envp,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+  /**
+   * @brief Index the environment of this process.
+   *
+   * @param resource The memory resource from which to allocate the snapshot
+   */
+  explicit EnvIndex(
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+  /**
+   * @brief Get the value of a variable.
+   *
+   * @param name The name of the variable
+   * @return std::optional<std::string_view> Its value, or nothing if it is
+   * not set
+   */
+  [[nodiscard]] std::optional<std::string_view>
+  find(std::string_view name) const;
+
+  // The index views the snapshot, which may be stored within this instance.
+  EnvIndex(const EnvIndex &) = delete;
+  EnvIndex &operator=(const EnvIndex &) = delete;
+
+private:
+  // Every variable, end to end.  m_vars views this.
+  std::pmr::string m_text;
+  std::pmr::unordered_map<std::string_view, std::string_view> m_vars;
+};
+} // namespace ArgParse::Internal
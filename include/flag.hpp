@@ -1,12 +1,15 @@
 #pragma once
 
+#include "flag_bits.hpp"
 #include "i_option.hpp"
 #include "parse_result.hpp"
+#include <memory_resource>
 #include <string_view>
 
 namespace ArgParse {
 /**
  * @brief Represents a boolean command-line flag, e.g., "-v|--verbose".
+ * Its SpecState holds a bool.
  *
  */
 struct Flag : public virtual IOption {
@@ -18,10 +21,14 @@ struct Flag : public virtual IOption {
    * @param short_name The short, single-dash name of this flag ("-v")
    * @param long_name The long, double-dash name of this flag ("--verbose")
    * @param help_msg A description of the purpose of this flag
+   * @param resource The memory resource from which this flag allocates its
+   * storage
    * @return Ptr A pointer to the new instance.
    */
-  static Ptr create(std::string_view short_name, std::string_view long_name,
-                    std::string_view help_msg);
+  static Ptr create(
+      std::string_view short_name, std::string_view long_name,
+      std::string_view help_msg,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 
   /**
    * @brief Find out whether this flag is set.  Call
@@ -31,6 +38,18 @@ struct Flag : public virtual IOption {
    * @return whether or not this flag has been set
    */
   [[nodiscard]] virtual bool is_set() const = 0;
+
+  /**
+   * @brief Keep this flag's state in a block of packed flag states.  An
+   * ArgumentParser calls this when the flag is added to it, so that
+   * is_set() reads a bit of the parser's block.
+   *
+   * @param bits The block, in which this flag takes a new bit.  The flag
+   * keeps its current state, and releases its bit in any previous block.
+   * @return size_t The index of the flag's bit, which the parser may set
+   * directly
+   */
+  virtual size_t store_in(const Internal::FlagBits::Ptr &bits) = 0;
 };
 
 } // namespace ArgParse
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace ArgParse::Internal {
+/**
+ * @brief The states of a parser's flags, packed one bit per flag.  This is
+ * for internal use.
+ *
+ * A flag added to a parser keeps its state here rather than in its own
+ * allocation, so the states of hundreds of flags share a few cache lines.
+ */
+class FlagBits {
+public:
+  using Ptr = std::shared_ptr<FlagBits>;
+
+  explicit FlagBits(
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : m_words(resource), m_released(resource) {}
+
+  /**
+   * @brief Make room for another flag.
+   *
+   * @return size_t The index of its bit, which is initially clear
+   */
+  size_t add() {
+    if (m_size % word_bits == 0) {
+      m_words.push_back(0);
+      m_released.push_back(0);
+    }
+    return m_size++;
+  }
+
+  [[nodiscard]] bool test(size_t bit) const {
+    return ((m_words[bit / word_bits] >> (bit % word_bits)) & 1) != 0;
+  }
+
+  void set(size_t bit, bool value) {
+    const uint64_t mask = uint64_t{1} << (bit % word_bits);
+    uint64_t &word = m_words[bit / word_bits];
+    word = value ? (word | mask) : (word & ~mask);
+  }
+
+  /**
+   * @brief Give up a bit whose flag now keeps its state in another block,
+   * e.g., because the flag was added to another parser too.
+   *
+   * @param bit The index of the bit
+   */
+  void release(size_t bit) {
+    m_released[bit / word_bits] |= uint64_t{1} << (bit % word_bits);
+  }
+
+  /// Whether a bit still holds its flag's state.
+  [[nodiscard]] bool holds(size_t bit) const {
+    return ((m_released[bit / word_bits] >> (bit % word_bits)) & 1) == 0;
+  }
+
+private:
+  static constexpr size_t word_bits = 64;
+
+  std::pmr::vector<uint64_t> m_words;
+  // The bits given up by release().
+  std::pmr::vector<uint64_t> m_released;
+  size_t m_size{0};
+};
+} // namespace ArgParse::Internal
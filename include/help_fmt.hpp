@@ -1,6 +1,8 @@
 #pragma once
 
 #include "nargs.hpp"
+#include <memory_resource>
+#include <span>
 #include <string>
 
 /**
@@ -74,4 +76,51 @@ std::string option_help_block(std::string_view short_name,
  */
 std::string arg_help_block(std::string_view arg_name, Nargs nargs,
                            std::string_view help_msg);
+
+/**
+ * @brief Get a usage string for the subcommand of a parser.
+ *
+ * @return std::string The usage string
+ */
+std::string command_usage_str();
+
+/**
+ * @brief Get the help message of a choice, listing its valid values.
+ *
+ * @param help_msg A help message describing the meaning of the choice
+ * @param choices The valid values
+ * @return std::string The help message
+ */
+std::string choice_help_msg(std::string_view help_msg,
+                            std::span<const std::pmr::string> choices);
+
+/**
+ * @brief Get the help message of an option, noting the environment variable
+ * from which it takes its value, if any.
+ *
+ * @param help_msg A help message describing the meaning of the option
+ * @param env_var The name of the environment variable, or an empty string
+ * @return std::string The help message
+ */
+std::string env_help_msg(std::string_view help_msg, std::string_view env_var);
+
+/**
+ * @brief Get a detailed help string describing a subcommand.
+ *
+ * @param name The name of the subcommand
+ * @param summary A one-line description of the subcommand
+ * @return std::string A detailed help message
+ */
+std::string command_help_block(std::string_view name, std::string_view summary);
+
+/**
+ * @brief Wrap help text to a width.  A line that is too wide is broken
+ * between words, and its continuation lines keep its indentation.  Words
+ * too wide to fit are left whole.
+ *
+ * @param text The text to wrap
+ * @param width The width in columns, or 0 to leave the text unwrapped
+ * @return std::string The wrapped text
+ */
+std::string wrap_text(std::string_view text, size_t width);
 } // namespace ArgParse::Internal
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "aliases.hpp"
+#include "arg_cursor.hpp"
 #include "nargs.hpp"
 #include "parse_result.hpp"
 #include <memory>
@@ -8,6 +9,25 @@
 
 namespace ArgParse {
 
+namespace Internal {
+/**
+ * @brief Lets a parser call a positional argument through plain function
+ * pointers rather than virtual functions.  This is for internal use.
+ */
+struct ArgumentDispatch {
+  using Parse = ParseResult (*)(void *self, ArgCursor &args);
+  using ParseState = ParseResult (*)(const void *self, ArgCursor &args,
+                                     SpecState &state);
+
+  /// The object that the functions are given, e.g., an Argument<int>
+  void *self;
+  /// Does what IArgument::parse(args) does
+  Parse parse;
+  /// Does what IArgument::parse(args, state) does
+  ParseState parse_state;
+};
+} // namespace Internal
+
 /**
  * @brief Defines the required interface of any positional argument spec.  Don't
  * use this.  Use, e.g., Argument.
@@ -49,7 +69,64 @@ struct IArgument {
    * @return ParseResult An indication of whether this argument consumed any
    * command line arguments; and, if so, whether any errors were encountered
    */
-  virtual ParseResult parse(ArgSeq &args) = 0;
+  virtual ParseResult parse(ArgCursor &args) = 0;
+
+  /**
+   * @brief Get this argument's state before any arguments are parsed into a
+   * ParseContext.
+   *
+   * @return SpecState The initial state, e.g., an empty sequence of values
+   */
+  [[nodiscard]] virtual SpecState initial_state() const = 0;
+
+  /**
+   * @brief Parse into state instead of into this argument.  This does not
+   * modify the argument, so it may be called from several threads at once.
+   *
+   * @param args The sequence of command-line arguments that have not yet been
+   * consumed
+   * @param state State previously created by initial_state()
+   * @return ParseResult An indication of whether this argument consumed any
+   * command line arguments; and, if so, whether any errors were encountered
+   */
+  virtual ParseResult parse(ArgCursor &args, SpecState &state) const = 0;
+
+  /**
+   * @brief Complete any work deferred by parse, once all command-line
+   * arguments have been parsed.
+   *
+   * @return OptErrMsg A description of the first invalid value, if any
+   */
+  virtual OptErrMsg finish() { return {}; }
+
+  /**
+   * @brief Complete any work deferred by parse into state, once all
+   * command-line arguments have been parsed.
+   *
+   * @param state State previously created by initial_state()
+   * @return OptErrMsg A description of the first invalid value, if any
+   */
+  virtual OptErrMsg finish(SpecState & /*state*/) const { return {}; }
+
+  /**
+   * @brief Discard any work deferred by parse, when parsing stops before
+   * finish is called, e.g., because help was requested.  Deferred work may
+   * view command-line arguments that don't outlive the parse.
+   */
+  virtual void discard_pending() {}
+
+  /**
+   * @brief Discard any work deferred by parse into state.
+   *
+   * @param state State previously created by initial_state()
+   */
+  virtual void discard_pending(SpecState & /*state*/) const {}
+
+  /**
+   * @brief Discard any values parsed for this argument, keeping the storage
+   * that held them.
+   */
+  virtual void reset() = 0;
 
   /**
    * @brief Call this after calling parse, to find out whether this argument
@@ -69,5 +146,35 @@ struct IArgument {
    * argument.
    */
   [[nodiscard]] virtual size_t num_values() const = 0;
+
+  /**
+   * @brief Get the number of command-line arguments held by state.
+   *
+   * @param state State previously created by initial_state()
+   * @return size_t The number of command-line arguments matched into state
+   */
+  [[nodiscard]] virtual size_t num_values(const SpecState &state) const = 0;
+
+  /**
+   * @brief Describe how an ArgumentParser should call this argument.  A
+   * parser calls this once, when the argument is added, and thereafter
+   * calls parse through the result.  The default calls the virtual
+   * functions; Argument supplies functions that don't.
+   *
+   * @return Internal::ArgumentDispatch The argument's functions
+   */
+  [[nodiscard]] virtual Internal::ArgumentDispatch dispatch() {
+    return {this, &virtual_parse, &virtual_parse_state};
+  }
+
+private:
+  static ParseResult virtual_parse(void *self, ArgCursor &args) {
+    return static_cast<IArgument *>(self)->parse(args);
+  }
+
+  static ParseResult virtual_parse_state(const void *self, ArgCursor &args,
+                                         SpecState &state) {
+    return static_cast<const IArgument *>(self)->parse(args, state);
+  }
 };
 } // namespace ArgParse
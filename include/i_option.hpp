@@ -2,10 +2,45 @@
 
 #include "aliases.hpp"
 #include "parse_result.hpp"
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace ArgParse {
+
+namespace Internal {
+/// What kind of value an option takes.
+enum class OptionKind : uint8_t {
+  /// None: the option is a flag
+  flag,
+  /// Any value of the option's type
+  option,
+  /// One of the values listed by IOption::value_candidates()
+  choice
+};
+
+/**
+ * @brief Lets a parser call an option through plain function pointers
+ * rather than virtual functions.  This is for internal use.
+ */
+struct OptionDispatch {
+  using ParseValue = ParseResult (*)(void *self, std::string_view source,
+                                     std::string_view value);
+  using ParseState = ParseResult (*)(const void *self, std::string_view source,
+                                     std::string_view value, SpecState &state);
+
+  OptionKind kind;
+  /// The object that the functions are given, e.g., an Option<int>
+  void *self;
+  /// Does what IOption::parse_value(source, value) does
+  ParseValue parse_value;
+  /// Does what IOption::parse_value(source, value, state) does
+  ParseState parse_state;
+};
+} // namespace Internal
+
 /**
  * @brief Defines the required interface of any option or flag spec.  Don't use
  * this.  Use, e.g., Option or Flag.
@@ -17,6 +52,127 @@ struct IOption {
   [[nodiscard]] virtual std::string usage() const = 0;
   [[nodiscard]] virtual std::string help() const = 0;
 
-  virtual ParseResult parse(ArgSeq &args) = 0;
+  /**
+   * @brief Get the short name of this option, e.g., "-o".  An
+   * ArgumentParser uses this and long_name() to index its options.
+   *
+   * @return std::string_view The short name
+   */
+  [[nodiscard]] virtual std::string_view short_name() const = 0;
+
+  /**
+   * @brief Get the long name of this option, e.g., "--output".
+   *
+   * @return std::string_view The long name
+   */
+  [[nodiscard]] virtual std::string_view long_name() const = 0;
+
+  /**
+   * @brief Find out whether this option takes a value, as "--output FILE"
+   * does, rather than being a flag.
+   */
+  [[nodiscard]] virtual bool takes_value() const = 0;
+
+  /**
+   * @brief List the values this option accepts, for shell completion.
+   *
+   * @return std::vector<std::string> The values, or nothing if any value of
+   * the right type is accepted
+   */
+  [[nodiscard]] virtual std::vector<std::string> value_candidates() const = 0;
+
+  /**
+   * @brief Get this option's state before any arguments are parsed into a
+   * ParseContext.
+   *
+   * @return SpecState The initial state, e.g., the option's default value
+   */
+  [[nodiscard]] virtual SpecState initial_state() const = 0;
+
+  /**
+   * @brief Take this option's value from an environment variable when the
+   * option is not given on the command line.  This may be called after the
+   * option is added to a parser, even after parsing; the parser's help and
+   * its next parse then use the new variable.  A compiled parser keeps the
+   * variable that was set when it was compiled.
+   *
+   * @param name The name of the environment variable, or an empty string to
+   * stop using one
+   */
+  virtual void set_env_var(std::string_view name) = 0;
+
+  /**
+   * @brief Get the name of the environment variable from which this option
+   * takes its value, if any.
+   *
+   * @return std::string_view The name, or an empty string
+   */
+  [[nodiscard]] virtual std::string_view env_var() const = 0;
+
+  /**
+   * @brief Parse a value for this option.  An ArgumentParser matches the
+   * option's name itself, and gives only the value: that given on the
+   * command line, by this option's environment variable or by a config
+   * file.  A flag given on the command line is given "true".
+   *
+   * @param source Names the origin of the value in error messages, e.g., the
+   * option as given, or the name of the environment variable.  It must
+   * outlive the result.
+   * @param value The value
+   * @return ParseResult Whether the value was valid
+   */
+  virtual ParseResult parse_value(std::string_view source,
+                                  std::string_view value) = 0;
+
+  /**
+   * @brief Parse a value into state instead of into this option.  This does
+   * not modify the option, so it may be called from several threads at
+   * once.
+   *
+   * @param source Names the origin of the value in error messages
+   * @param value The value
+   * @param state State previously created by initial_state()
+   * @return ParseResult Whether the value was valid
+   */
+  virtual ParseResult parse_value(std::string_view source,
+                                  std::string_view value,
+                                  SpecState &state) const = 0;
+
+  /**
+   * @brief Restore this option to its state before any arguments were
+   * parsed, keeping any storage it has allocated.
+   */
+  virtual void reset() = 0;
+
+  /**
+   * @brief Describe how an ArgumentParser should call this option.  A parser
+   * calls this once, when the option is added, and thereafter calls
+   * parse_value through the result.  The default calls the virtual
+   * functions; Option, Flag and the choices supply functions that don't.
+   *
+   * @return Internal::OptionDispatch The option's kind and functions
+   */
+  [[nodiscard]] virtual Internal::OptionDispatch dispatch() {
+    Internal::OptionKind kind = Internal::OptionKind::flag;
+    if (takes_value()) {
+      kind = value_candidates().empty() ? Internal::OptionKind::option
+                                        : Internal::OptionKind::choice;
+    }
+    return {kind, this, &virtual_parse_value, &virtual_parse_state};
+  }
+
+private:
+  static ParseResult virtual_parse_value(void *self, std::string_view source,
+                                         std::string_view value) {
+    return static_cast<IOption *>(self)->parse_value(source, value);
+  }
+
+  static ParseResult virtual_parse_state(const void *self,
+                                         std::string_view source,
+                                         std::string_view value,
+                                         SpecState &state) {
+    return static_cast<const IOption *>(self)->parse_value(source, value,
+                                                           state);
+  }
 };
 } // namespace ArgParse
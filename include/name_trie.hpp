@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace ArgParse::Internal {
+/**
+ * @brief Maps long option names to indices, matching both whole names and
+ * unambiguous abbreviations of them in one walk.  This is for internal use.
+ *
+ * This is a radix trie: each edge is labelled with a run of characters, and
+ * each node counts the names below it, so a walk that ends partway down the
+ * trie knows at once whether it has abbreviated exactly one name.  Names are
+ * not copied; they must outlive the trie.
+ */
+class NameTrie {
+public:
+  /// The outcome of looking up a name.
+  struct Match {
+    enum class Kind {
+      none,         ///< No name starts with the key
+      exact,        ///< The key is a name
+      abbreviation, ///< The key starts exactly one name
+      ambiguous,    ///< The key starts several names, and is none of them
+    };
+    Kind kind{Kind::none};
+    /// The index of the matched name, if exact or abbreviation.
+    size_t index{0};
+  };
+
+  explicit NameTrie(
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+  NameTrie(const NameTrie &src, std::pmr::memory_resource *resource)
+      : m_nodes(src.m_nodes, resource) {}
+
+  /// Remove every name.
+  void clear();
+
+  /**
+   * @brief Make room for names, so that adding them allocates at most once.
+   *
+   * @param num_names The number of names the trie will hold
+   */
+  void reserve(size_t num_names);
+
+  /**
+   * @brief Add a name.
+   *
+   * @param name The name, which must not already be in the trie
+   * @param index The index to which it maps
+   */
+  void insert(std::string_view name, size_t index);
+
+  /**
+   * @brief Look up a name or an abbreviation of one.
+   *
+   * @param key The name or abbreviation
+   * @return Match How key matches the names in the trie
+   */
+  [[nodiscard]] Match find(std::string_view key) const;
+
+  /**
+   * @brief Find every name that starts with a prefix.
+   *
+   * @param prefix The prefix
+   * @return std::vector<size_t> The indices of the names, in no particular
+   * order
+   */
+  [[nodiscard]] std::vector<size_t> find_all(std::string_view prefix) const;
+
+private:
+  static constexpr uint32_t no_node = 0;
+
+  struct Node {
+    // The run of characters on the edge from the parent.
+    std::string_view label;
+    // The root is never a child, so its index marks the absence of a node.
+    uint32_t first_child{no_node};
+    uint32_t next_sibling{no_node};
+    // The number of names that end at or below this node.
+    uint32_t num_names{0};
+    bool has_name{false};
+    // The index of the name that ends here, if has_name; otherwise that of
+    // a name below, which is the only one if num_names is 1.
+    size_t index{0};
+  };
+
+  std::pmr::vector<Node> m_nodes;
+
+  [[nodiscard]] uint32_t find_child(uint32_t node, char first) const;
+
+  // Walk toward key, stopping where it ends or stops matching.  Answers the
+  // node at or below which key ends, or no_node if nothing matches.
+  [[nodiscard]] uint32_t walk(std::string_view key, bool &at_node) const;
+};
+} // namespace ArgParse::Internal
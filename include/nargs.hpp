@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace ArgParse {
 
 /**
@@ -16,4 +18,19 @@ enum class Nargs {
   one_or_more = 2
 };
 
+namespace Internal {
+/// Find out whether num_values values satisfy nargs.
+constexpr bool nargs_satisfied(Nargs nargs, size_t num_values) {
+  switch (nargs) {
+  case Nargs::one:
+    return num_values == 1;
+  case Nargs::zero_or_more:
+    return true;
+  case Nargs::one_or_more:
+    return num_values > 0;
+  }
+  return false;
+}
+} // namespace Internal
+
 } // namespace ArgParse
@@ -1,30 +1,25 @@
 #pragma once
 
+#include "allocation.hpp"
 #include "help_fmt.hpp"
 #include "i_option.hpp"
 #include "value_converter.hpp"
-#include <functional>
 #include <iostream>
+#include <memory_resource>
 #include <sstream>
+#include <string>
 
 namespace ArgParse {
 
-namespace Internal {
-using Setter = std::function<OptErrMsg(std::string_view opt_name,
-                                       std::string_view opt_sval)>;
-ParseResult parse_and_set(std::string_view short_name,
-                          std::string_view long_name, Setter setter,
-                          ArgSeq &args);
-
-} // namespace Internal
-
 /**
  * @brief Represents a command-line option with an associated value.
+ * Its SpecState holds a T.
  *
  * @tparam T The type of the value for this option spec.
  */
 template <typename T> struct Option : public IOption {
   using Ptr = std::shared_ptr<Option<T>>;
+  using value_type = T;
 
   /**
    * @brief Create a new command-line option spec.
@@ -32,32 +27,45 @@ template <typename T> struct Option : public IOption {
    * @param short_name The short name of the option, e.g., "-o"
    * @param long_name The long name of the option, e.g., "--output"
    * @param help_msg A description of the purpose of this option
+   * @param default_value The value of this option if it is not given on the
+   * command line
+   * @param resource The memory resource from which this option allocates
+   * its storage
    * @return Ptr A pointer to the created instance
    */
-  static Ptr create(std::string_view short_name, std::string_view long_name,
-                    std::string_view help_msg, const T default_value = {}) {
-    return std::shared_ptr<Option>(
-        new Option(short_name, long_name, help_msg, default_value));
+  static Ptr create(
+      std::string_view short_name, std::string_view long_name,
+      std::string_view help_msg, const T default_value = {},
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+    return Internal::make_shared_in<Created>(
+        resource, short_name, long_name, help_msg, default_value, resource);
+  }
+
+  [[nodiscard]] bool takes_value() const override { return true; }
+
+  [[nodiscard]] std::vector<std::string> value_candidates() const override {
+    return {};
   }
 
-  ParseResult parse(ArgSeq &args) override {
-    auto setter{
-        [this](std::string_view name, std::string_view sval) -> OptErrMsg {
-          Internal::ValueConverter<T> converter(name, sval);
-          if (converter.m_err_msg) {
-            return converter.m_err_msg;
-          }
+  [[nodiscard]] SpecState initial_state() const override { return m_default; }
 
-          // Do any Option-specific validation.
-          if (!valid_value(converter.m_value)) {
-            return Internal::invalid_value_msg(name, sval);
-          }
+  void set_env_var(std::string_view name) override { m_env_var = name; }
 
-          m_value = converter.m_value;
-          return {};
-        }};
+  [[nodiscard]] std::string_view env_var() const override { return m_env_var; }
 
-    return Internal::parse_and_set(m_short, m_long, setter, args);
+  ParseResult parse_value(std::string_view source,
+                          std::string_view value) final {
+    return set_value(source, value, m_value);
+  }
+
+  ParseResult parse_value(std::string_view source, std::string_view value,
+                          SpecState &state) const final {
+    return set_value(source, value, std::any_cast<T &>(state));
+  }
+
+  [[nodiscard]] Internal::OptionDispatch dispatch() override {
+    return {Internal::OptionKind::option, this, &dispatch_parse_value,
+            &dispatch_parse_state};
   }
 
   /**
@@ -68,27 +76,81 @@ template <typename T> struct Option : public IOption {
    */
   [[nodiscard]] T value() const { return m_value; }
 
+  void reset() override { m_value = m_default; }
+
   [[nodiscard]] std::string usage() const override {
     return Internal::option_usage_str(m_short, m_long);
   }
 
   [[nodiscard]] std::string help() const override {
-    return Internal::option_help_block(m_short, m_long, m_help_msg);
+    return Internal::option_help_block(
+        m_short, m_long, Internal::env_help_msg(m_help_msg, m_env_var));
+  }
+
+  [[nodiscard]] std::string_view short_name() const override {
+    return m_short;
   }
 
+  [[nodiscard]] std::string_view long_name() const override { return m_long; }
+
 protected:
-  const std::string m_short;
-  const std::string m_long;
-  const std::string m_help_msg;
+  const std::pmr::string m_short;
+  const std::pmr::string m_long;
+  const std::pmr::string m_help_msg;
+  std::pmr::string m_env_var;
 
+  const T m_default;
   T m_value;
 
   Option(std::string_view short_name, std::string_view long_name,
-         std::string_view help_msg, const T default_value)
-      : m_short(short_name), m_long(long_name), m_help_msg(help_msg),
+         std::string_view help_msg, const T default_value,
+         std::pmr::memory_resource *resource)
+      : m_short(short_name, resource), m_long(long_name, resource),
+        m_help_msg(help_msg, resource), m_env_var(resource),
+        m_default(default_value),
         m_value(default_value) {}
 
   [[nodiscard]] virtual bool valid_value(const T &v) const { return true; }
+
+private:
+  struct Created;
+
+  static ParseResult dispatch_parse_value(void *self, std::string_view source,
+                                          std::string_view value) {
+    auto *option = static_cast<Option<T> *>(self);
+    return option->set_value(source, value, option->m_value);
+  }
+
+  static ParseResult dispatch_parse_state(const void *self,
+                                          std::string_view source,
+                                          std::string_view value,
+                                          SpecState &state) {
+    return static_cast<const Option<T> *>(self)->set_value(
+        source, value, std::any_cast<T &>(state));
+  }
+
+  ParseResult set_value(std::string_view name, std::string_view sval,
+                        T &dest) const {
+    Internal::ValueConverter<T> converter(name, sval);
+    if (converter.failed()) {
+      return converter.as_parse_result();
+    }
+
+    // Do any Option-specific validation.
+    if (!valid_value(converter.m_value)) {
+      return ParseResult::match_with_error(ParseError::invalid_value, name,
+                                           sval);
+    }
+
+    dest = std::move(converter.m_value);
+    return ParseResult::match();
+  }
+};
+
+// Makes the protected constructor available to make_shared_in.
+template <typename T> struct Option<T>::Created : public Option<T> {
+  template <typename... Args>
+  Created(Args &&...args) : Option<T>(std::forward<Args>(args)...) {}
 };
 
 } // namespace ArgParse
\ No newline at end of file
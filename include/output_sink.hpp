@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <string_view>
+
+namespace ArgParse {
+/**
+ * @brief Receives the help and error messages of parsers.
+ *
+ * Parsers assemble each message in full before handing it to a sink, so a
+ * sink can emit it with a single write.  Implement this interface to capture
+ * a parser's output without redirecting the standard streams.
+ *
+ * A compiled parser may write to its sink from several threads at once.
+ */
+struct OutputSink {
+  using Ptr = std::shared_ptr<OutputSink>;
+
+  /// The stream for which a message is meant.
+  enum class Stream {
+    out, ///< Requested output, e.g., help
+    err, ///< Error messages
+  };
+
+  virtual ~OutputSink() = default;
+
+  /**
+   * @brief Get the width, in columns, to which help text is wrapped.  Parsers
+   * query this when the sink is given to them.
+   *
+   * @return size_t The width, or 0 to leave text unwrapped
+   */
+  [[nodiscard]] virtual size_t width() const { return 0; }
+
+  /**
+   * @brief Find out whether this sink discards every message.  Parsers
+   * don't format error messages for such a sink.  They query this when the
+   * sink is given to them.
+   */
+  [[nodiscard]] virtual bool discards() const { return false; }
+
+  /**
+   * @brief Write a complete message.
+   *
+   * @param stream The stream for which the message is meant
+   * @param message The message, including its final newline
+   */
+  virtual void write(Stream stream, std::string_view message) = 0;
+
+  /**
+   * @brief Get the sink that parsers use by default.  It writes to std::cout
+   * and std::cerr, flushing once per message, and wraps help text to the
+   * width given by the COLUMNS environment variable or, failing that, to the
+   * width of the terminal, if standard output is one.
+   *
+   * @return Ptr The default sink
+   */
+  static Ptr standard();
+
+  /**
+   * @brief Create a sink that writes to a pair of streams.
+   *
+   * @param outs Receives requested output, e.g., help
+   * @param errs Receives error messages
+   * @param width The width to which help text is wrapped, or 0 to leave it
+   * unwrapped
+   * @return Ptr A new sink.  It refers to outs and errs, which must outlive
+   * it.
+   */
+  static Ptr create(std::ostream &outs, std::ostream &errs, size_t width = 0);
+
+  /**
+   * @brief Get a sink that discards every message, e.g., for trying a
+   * command line against several parsers.
+   *
+   * @return Ptr The discarding sink
+   */
+  static Ptr discard();
+};
+} // namespace ArgParse
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "aliases.hpp"
+#include "value_converter.hpp"
+#include <algorithm>
+#include <concepts>
+#include <exception>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace ArgParse::Internal {
+
+/// The first invalid token within a range of tokens.  Its message is
+/// formatted only if it is the first invalid token of all.
+struct ConversionError {
+  size_t m_index;
+  ParseError m_error;
+};
+
+/// Convert tokens[begin, end) into dest[begin, end), stopping at the first
+/// invalid token.
+template <typename T, typename Dest>
+std::optional<ConversionError>
+convert_range(std::string_view name, std::span<const std::string_view> tokens,
+              Dest dest, size_t begin, size_t end) {
+  for (size_t i = begin; i < end; ++i) {
+    ValueConverter<T> converter(name, tokens[i]);
+    if (converter.failed()) {
+      return ConversionError{i, converter.m_error};
+    }
+    dest[i] = std::move(converter.m_value);
+  }
+  return std::nullopt;
+}
+
+/**
+ * @brief Convert a sequence of tokens, appending the results to values.
+ * When there are at least twice min_chunk tokens, they are split into chunks
+ * of at least min_chunk tokens which are converted on separate threads.
+ *
+ * Errors are reported as if the tokens had been converted in order: the
+ * result describes the first invalid token, and values receives only the
+ * tokens before it.
+ *
+ * @tparam T The type to convert to
+ * @param name The name to use in error messages
+ * @param tokens The tokens to convert
+ * @param values Receives the converted values
+ * @param min_chunk The fewest tokens to convert on a thread; 0 to convert
+ * all tokens on the calling thread
+ * @return OptErrMsg A description of the first invalid token, if any
+ */
+template <typename T, typename Values>
+OptErrMsg convert_all(std::string_view name,
+                      std::span<const std::string_view> tokens,
+                      Values &values, size_t min_chunk) {
+  const size_t offset = values.size();
+  values.resize(offset + tokens.size());
+  auto dest = values.begin() + static_cast<std::ptrdiff_t>(offset);
+
+  size_t num_chunks = 1;
+  // Elements of a std::vector<bool> can't be written concurrently.
+  if constexpr (!std::same_as<T, bool>) {
+    // Querying the number of cores is not free, so only do it when there
+    // is more than one chunk's worth of work.
+    if ((min_chunk > 0) && (tokens.size() / min_chunk > 1)) {
+      const size_t max_threads =
+          std::max(1U, std::thread::hardware_concurrency());
+      num_chunks = std::min(tokens.size() / min_chunk, max_threads);
+    }
+  }
+
+  // Most arguments take too few values to split, so skip the bookkeeping
+  // that threads need.
+  if (num_chunks == 1) {
+    std::optional<ConversionError> error;
+    try {
+      error = convert_range<T>(name, tokens, dest, 0, tokens.size());
+    } catch (...) {
+      values.resize(offset);
+      throw;
+    }
+    if (error) {
+      values.resize(offset + error->m_index);
+      return error_msg(error->m_error, name, tokens[error->m_index]);
+    }
+    return {};
+  }
+
+  std::vector<std::optional<ConversionError>> errors(num_chunks);
+  std::vector<std::exception_ptr> failures(num_chunks);
+  auto convert_chunk = [&](size_t chunk) {
+    const size_t begin = tokens.size() * chunk / num_chunks;
+    const size_t end = tokens.size() * (chunk + 1) / num_chunks;
+    try {
+      errors[chunk] = convert_range<T>(name, tokens, dest, begin, end);
+    } catch (...) {
+      failures[chunk] = std::current_exception();
+    }
+  };
+
+  {
+    std::vector<std::jthread> workers;
+    workers.reserve(num_chunks - 1);
+    for (size_t chunk = 1; chunk < num_chunks; ++chunk) {
+      workers.emplace_back(convert_chunk, chunk);
+    }
+    convert_chunk(0);
+  }
+
+  for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+    if (failures[chunk]) {
+      values.resize(offset);
+      std::rethrow_exception(failures[chunk]);
+    }
+    if (errors[chunk]) {
+      const size_t index = errors[chunk]->m_index;
+      values.resize(offset + index);
+      return error_msg(errors[chunk]->m_error, name, tokens[index]);
+    }
+  }
+  return {};
+}
+} // namespace ArgParse::Internal
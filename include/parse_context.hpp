@@ -0,0 +1,222 @@
+#pragma once
+
+#include "aliases.hpp"
+#include "arg_cursor.hpp"
+#include "flag.hpp"
+#include "i_argument.hpp"
+#include "i_option.hpp"
+#include "response_file.hpp"
+#include <any>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ArgParse {
+
+namespace Internal {
+/// The layout of a ParseContext's states, worked out when a CompiledParser
+/// is compiled: the options' states come first, then the arguments'.
+struct SpecSlots {
+  explicit SpecSlots(std::pmr::memory_resource *resource)
+      : options(resource), arguments(resource), initial_states(resource) {}
+
+  /// Maps each spec to the index of its state.
+  std::pmr::unordered_map<const IOption *, size_t> options;
+  std::pmr::unordered_map<const IArgument *, size_t> arguments;
+  /// Every spec's state before any arguments are parsed.
+  std::pmr::vector<SpecState> initial_states;
+  size_t num_options{0};
+};
+} // namespace Internal
+
+/**
+ * @brief Holds the results of one call to CompiledParser::parse_args.
+ *
+ * Results are looked up by the specs that were added to the ArgumentParser
+ * from which the CompiledParser was compiled.  A context allocates its
+ * states from the memory resource given to parse_args, so it must not
+ * outlive that resource:
+ *
+ * @code
+ * auto context = compiled->parse_args(args);
+ * if (!context.should_exit()) {
+ *   int jobs = context.value(jobs_option);
+ * }
+ * @endcode
+ */
+class ParseContext {
+public:
+  /**
+   * @brief Find out whether or not the program should exit due to invalid
+   * command-line arguments.
+   *
+   * @return true if the command-line arguments were invalid
+   * @return false if the command-line arguments were valid
+   */
+  [[nodiscard]] bool should_exit() const { return m_exit_code.has_value(); }
+
+  /**
+   * @brief Get the recommended exit code.  If should_exit() returns true,
+   * the program should be terminated with this exit code.
+   *
+   * @return int The recommended exit code
+   */
+  [[nodiscard]] int exit_code() const { return m_exit_code.value_or(0); }
+
+  /**
+   * @brief Find out whether a flag was set.
+   *
+   * @param flag A flag of the parser that produced this context
+   * @return whether or not the flag was set
+   * @throws std::invalid_argument if the flag does not belong to the parser
+   */
+  [[nodiscard]] bool is_set(const Flag::Ptr &flag) const {
+    return std::any_cast<bool>(m_states[option_slot(flag.get())]);
+  }
+
+  /**
+   * @brief Get the value of an option.
+   *
+   * @param option An option of the parser that produced this context
+   * @return The value of the option, or its default value if it was not
+   * given on the command line
+   * @throws std::invalid_argument if the option does not belong to the parser
+   */
+  template <typename O>
+  [[nodiscard]] const typename O::value_type &
+  value(const std::shared_ptr<O> &option) const {
+    return std::any_cast<const typename O::value_type &>(
+        m_states[option_slot(option.get())]);
+  }
+
+  /**
+   * @brief Get the values of a positional argument.
+   *
+   * @param argument An argument of the parser that produced this context
+   * @return The command-line values matched by the argument.  This is empty
+   * for a streaming argument.
+   * @throws std::invalid_argument if the argument does not belong to the
+   * parser
+   */
+  template <typename A>
+  [[nodiscard]] const std::vector<typename A::value_type> &
+  values(const std::shared_ptr<A> &argument) const {
+    using Values = std::vector<typename A::value_type>;
+    const auto *values =
+        std::any_cast<Values>(&m_states[arg_slot(argument.get())]);
+    static const Values none;
+    return values ? *values : none;
+  }
+
+  /**
+   * @brief Get the number of values matched by a positional argument,
+   * including a streaming argument.
+   *
+   * @param argument An argument of the parser that produced this context
+   * @return size_t The number of values
+   * @throws std::invalid_argument if the argument does not belong to the
+   * parser
+   */
+  [[nodiscard]] size_t num_values(const IArgument::Ptr &argument) const {
+    return argument->num_values(m_states[arg_slot(argument.get())]);
+  }
+
+private:
+  friend struct CompiledImpl;
+
+  std::shared_ptr<const Internal::SpecSlots> m_slots;
+  std::pmr::vector<SpecState> m_states;
+  std::optional<int> m_exit_code;
+  // Arguments read from response files, which parsed values may view.
+  Internal::ResponseFiles m_response_files;
+
+  ParseContext(std::shared_ptr<const Internal::SpecSlots> slots,
+               std::pmr::memory_resource *resource)
+      : m_slots(std::move(slots)),
+        m_states(m_slots->initial_states, resource),
+        m_response_files(resource) {}
+
+  [[nodiscard]] std::span<SpecState> option_states() {
+    return std::span(m_states).first(m_slots->num_options);
+  }
+
+  [[nodiscard]] std::span<SpecState> argument_states() {
+    return std::span(m_states).subspan(m_slots->num_options);
+  }
+
+  [[nodiscard]] size_t option_slot(const IOption *option) const {
+    auto found = m_slots->options.find(option);
+    if (found == m_slots->options.end()) {
+      throw std::invalid_argument("Option does not belong to this parser.");
+    }
+    return found->second;
+  }
+
+  [[nodiscard]] size_t arg_slot(const IArgument *argument) const {
+    auto found = m_slots->arguments.find(argument);
+    if (found == m_slots->arguments.end()) {
+      throw std::invalid_argument("Argument does not belong to this parser.");
+    }
+    return found->second;
+  }
+};
+
+/**
+ * @brief An immutable snapshot of an ArgumentParser's specs.  Create one
+ * with ArgumentParser::compile().
+ *
+ * Parsing does not modify a CompiledParser or its specs.  Each parse returns
+ * its results in a new ParseContext, so one CompiledParser can be shared by
+ * many threads without locking.
+ */
+struct CompiledParser {
+  using Ptr = std::shared_ptr<const CompiledParser>;
+
+  /**
+   * @brief Parse a sequence of command-line arguments.  The arguments are
+   * not copied.
+   *
+   * @param args Arguments to parse
+   * @param resource The memory resource from which the result allocates its
+   * states.  A parse uses it from one thread only.
+   * @return ParseContext The results of the parse
+   */
+  [[nodiscard]] ParseContext parse_args(
+      std::span<const std::string_view> args,
+      std::pmr::memory_resource *resource =
+          std::pmr::get_default_resource()) const {
+    ArgCursor cursor(args);
+    return parse(cursor, resource);
+  }
+
+  /**
+   * @brief Parse a sequence of command-line arguments.
+   * This overload eases use from `int main(int argc, char *argv[])`.  The
+   * arguments are not copied.
+   *
+   * @param argc The number of command-line arguments
+   * @param argv Array of command-line arguments
+   * @param resource The memory resource from which the result allocates its
+   * states.  A parse uses it from one thread only.
+   * @return ParseContext The results of the parse
+   */
+  [[nodiscard]] ParseContext parse_args(
+      int argc, char *argv[],
+      std::pmr::memory_resource *resource =
+          std::pmr::get_default_resource()) const {
+    ArgCursor cursor(std::span<char *const>(argv, argc));
+    return parse(cursor, resource);
+  }
+
+protected:
+  ~CompiledParser() = default;
+
+  [[nodiscard]] virtual ParseContext
+  parse(ArgCursor &args, std::pmr::memory_resource *resource) const = 0;
+};
+} // namespace ArgParse
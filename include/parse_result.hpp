@@ -1,34 +1,85 @@
 #pragma once
 
 #include "aliases.hpp"
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <utility>
+#include <string_view>
 
 namespace ArgParse {
 
+/**
+ * @brief Why a spec rejected the command-line arguments that it matched.
+ */
+enum class ParseError : uint8_t {
+  /// Nothing was rejected
+  none,
+  /// An option was given no value
+  missing_value,
+  /// A value is not valid for the spec
+  invalid_value,
+  /// A value starts with a valid value, but has trailing text
+  incomplete_value,
+  /// A value can't be represented by the spec's type
+  out_of_range,
+};
+
 /**
  * @brief Describes the result of parsing a command-line option or positional
  * parameter.  This is for internal use.
  *
+ * An error is recorded as a code plus views of the offending argument; its
+ * message is formatted only if error_msg() is called.  The views refer to
+ * the parsed arguments, which must outlive this result.
  */
 struct ParseResult {
-  ParseResult(bool matched, OptErrMsg error_msg)
-      : m_matched(matched), m_error_msg(std::move(error_msg)) {}
+  static ParseResult no_match() { return {false, ParseError::none, {}, {}}; }
 
-  static ParseResult no_match() { return {false, {}}; }
+  static ParseResult match() { return {true, ParseError::none, {}, {}}; }
 
-  static ParseResult match_with_error(std::string_view error_msg) {
-    return {true, std::string(error_msg)};
+  /**
+   * @brief Create the result of matching an argument with an invalid value.
+   *
+   * @param error Why the value was rejected
+   * @param name The name of the spec, as it should appear in the message
+   * @param value The rejected value, or for a missing value, the option that
+   * lacks it
+   */
+  static ParseResult match_with_error(ParseError error, std::string_view name,
+                                      std::string_view value) {
+    return {true, error, name, value};
   }
 
-  static ParseResult match() { return {true, {}}; }
-
   [[nodiscard]] bool matched() const { return m_matched; }
-  [[nodiscard]] OptErrMsg error_msg() const { return m_error_msg; }
+  [[nodiscard]] ParseError error() const { return m_error; }
+  [[nodiscard]] bool has_error() const { return m_error != ParseError::none; }
+
+  /**
+   * @brief Format a description of the error, if any.
+   */
+  [[nodiscard]] OptErrMsg error_msg() const;
 
 private:
-  const bool m_matched;
-  const OptErrMsg m_error_msg;
+  bool m_matched;
+  ParseError m_error;
+  std::string_view m_name;
+  std::string_view m_value;
+
+  ParseResult(bool matched, ParseError error, std::string_view name,
+              std::string_view value)
+      : m_matched(matched), m_error(error), m_name(name), m_value(value) {}
 };
 
-} // namespace ArgParse
\ No newline at end of file
+namespace Internal {
+/**
+ * @brief Format the message for an error.
+ *
+ * @param error Why a value was rejected; not ParseError::none
+ * @param name The name of the spec
+ * @param value The rejected value, or the option that lacks one
+ * @return std::string The message
+ */
+std::string error_msg(ParseError error, std::string_view name,
+                      std::string_view value);
+} // namespace Internal
+} // namespace ArgParse
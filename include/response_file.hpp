@@ -0,0 +1,109 @@
+#pragma once
+
+#include "aliases.hpp"
+#include "arg_cursor.hpp"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ArgParse::Internal {
+/**
+ * @brief A read-only view of a whole file.  On POSIX systems the file is
+ * memory-mapped rather than read.
+ */
+class MappedFile {
+public:
+  /**
+   * @brief Map a file.
+   *
+   * @param path The path of the file to map
+   * @throws std::system_error if the file can't be opened or mapped
+   */
+  explicit MappedFile(const std::string &path);
+  ~MappedFile();
+
+  MappedFile(MappedFile &&src) noexcept;
+  MappedFile &operator=(MappedFile &&src) noexcept;
+  MappedFile(const MappedFile &src) = delete;
+  MappedFile &operator=(const MappedFile &src) = delete;
+
+  /// The contents of the file.  Valid for the lifetime of this instance.
+  [[nodiscard]] std::string_view contents() const {
+    return {m_data, m_size};
+  }
+
+  /// Identifies the file independently of the path used to open it.
+  struct Id {
+    unsigned long long device{0};
+    unsigned long long inode{0};
+    bool operator==(const Id &other) const = default;
+  };
+
+  [[nodiscard]] Id id() const { return m_id; }
+
+private:
+  const char *m_data{nullptr};
+  size_t m_size{0};
+  Id m_id;
+  // Holds the contents where memory mapping is unavailable.
+  std::unique_ptr<char[]> m_buffer;
+
+  void unmap();
+};
+
+/**
+ * @brief Expands "@path" arguments into the arguments contained in the file
+ * at path.
+ *
+ * A response file holds arguments separated by whitespace.  An argument
+ * wrapped in single or double quotes may contain whitespace; the quotes are
+ * removed, and no escape sequences are interpreted.  Response files may name
+ * other response files, but not themselves, directly or indirectly.
+ *
+ * Expanded arguments view the mapped files, which stay mapped until clear()
+ * is called or this instance is destroyed.
+ */
+class ResponseFiles {
+public:
+  explicit ResponseFiles(
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : m_args(resource), m_files(resource) {}
+
+  /**
+   * @brief Find out whether any argument after the command name names a
+   * response file.
+   */
+  [[nodiscard]] static bool any_in(ArgCursor args);
+
+  /**
+   * @brief Expand all of the remaining arguments of a cursor, consuming them.
+   * Any previous expansion is discarded.
+   *
+   * @param args The arguments to expand
+   * @return OptErrMsg A description of the failure, if a response file could
+   * not be read
+   */
+  OptErrMsg expand(ArgCursor &args);
+
+  /// The arguments produced by the last call to expand().
+  [[nodiscard]] std::span<const std::string_view> args() const {
+    return m_args;
+  }
+
+  /// Discard the expanded arguments and unmap their files.
+  void clear();
+
+private:
+  std::pmr::vector<std::string_view> m_args;
+  std::pmr::vector<MappedFile> m_files;
+  // The files being expanded, outermost first.
+  std::vector<MappedFile::Id> m_active;
+
+  OptErrMsg expand_arg(std::string_view arg);
+  OptErrMsg expand_file(std::string_view path);
+};
+} // namespace ArgParse::Internal
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "i_argument.hpp"
+#include "i_option.hpp"
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace ArgParse::Internal {
+/**
+ * @brief The options of a parser, stored column by column.  This is for
+ * internal use.
+ *
+ * Matching and parsing read only the narrow columns: names, kinds, flag bits
+ * and dispatch functions.  These lie together in a few arrays, rather than
+ * one in each spec's own allocation, and calling through them needs no
+ * virtual call.  The specs are kept for help text and for cold queries.
+ */
+class OptionTable {
+public:
+  /// The flag bit of an option that keeps no state in a FlagBits.
+  static constexpr uint32_t no_bit = std::numeric_limits<uint32_t>::max();
+
+  explicit OptionTable(std::pmr::memory_resource *resource)
+      : m_short_names(resource), m_long_names(resource), m_kinds(resource),
+        m_flag_bits(resource), m_selves(resource), m_parse_value(resource),
+        m_parse_state(resource), m_specs(resource) {}
+
+  OptionTable(const OptionTable &src, std::pmr::memory_resource *resource)
+      : m_short_names(src.m_short_names, resource),
+        m_long_names(src.m_long_names, resource),
+        m_kinds(src.m_kinds, resource), m_flag_bits(src.m_flag_bits, resource),
+        m_selves(src.m_selves, resource),
+        m_parse_value(src.m_parse_value, resource),
+        m_parse_state(src.m_parse_state, resource),
+        m_specs(src.m_specs, resource) {}
+
+  /**
+   * @brief Add an option.
+   *
+   * @param spec The option
+   * @param flag_bit The bit in which a flag keeps its state, or no_bit
+   */
+  void add(IOption::Ptr spec, uint32_t flag_bit) {
+    const OptionDispatch dispatch = spec->dispatch();
+    m_short_names.push_back(spec->short_name());
+    m_long_names.push_back(spec->long_name());
+    m_kinds.push_back(dispatch.kind);
+    m_flag_bits.push_back(flag_bit);
+    m_selves.push_back(dispatch.self);
+    m_parse_value.push_back(dispatch.parse_value);
+    m_parse_state.push_back(dispatch.parse_state);
+    m_specs.push_back(std::move(spec));
+  }
+
+  [[nodiscard]] size_t size() const { return m_specs.size(); }
+
+  [[nodiscard]] bool empty() const { return m_specs.empty(); }
+
+  [[nodiscard]] std::string_view short_name(size_t index) const {
+    return m_short_names[index];
+  }
+
+  [[nodiscard]] std::string_view long_name(size_t index) const {
+    return m_long_names[index];
+  }
+
+  [[nodiscard]] OptionKind kind(size_t index) const { return m_kinds[index]; }
+
+  [[nodiscard]] bool takes_value(size_t index) const {
+    return m_kinds[index] != OptionKind::flag;
+  }
+
+  [[nodiscard]] uint32_t flag_bit(size_t index) const {
+    return m_flag_bits[index];
+  }
+
+  [[nodiscard]] const std::pmr::vector<IOption::Ptr> &specs() const {
+    return m_specs;
+  }
+
+  /// Parse a value into the option itself.
+  ParseResult parse_value(size_t index, std::string_view source,
+                          std::string_view value) const {
+    return m_parse_value[index](m_selves[index], source, value);
+  }
+
+  /// Parse a value into state, leaving the option untouched.
+  ParseResult parse_value(size_t index, std::string_view source,
+                          std::string_view value, SpecState &state) const {
+    return m_parse_state[index](m_selves[index], source, value, state);
+  }
+
+private:
+  // The names view strings owned by the specs.
+  std::pmr::vector<std::string_view> m_short_names;
+  std::pmr::vector<std::string_view> m_long_names;
+  std::pmr::vector<OptionKind> m_kinds;
+  std::pmr::vector<uint32_t> m_flag_bits;
+  std::pmr::vector<void *> m_selves;
+  std::pmr::vector<OptionDispatch::ParseValue> m_parse_value;
+  std::pmr::vector<OptionDispatch::ParseState> m_parse_state;
+  std::pmr::vector<IOption::Ptr> m_specs;
+};
+
+/**
+ * @brief The positional arguments of a parser, stored column by column.
+ * This is for internal use.
+ *
+ * Every argument is offered each positional command-line argument in turn,
+ * so the columns it reads lie together and are called without virtual
+ * calls.
+ */
+class ArgumentTable {
+public:
+  explicit ArgumentTable(std::pmr::memory_resource *resource)
+      : m_nargs(resource), m_selves(resource), m_parse(resource),
+        m_parse_state(resource), m_specs(resource) {}
+
+  ArgumentTable(const ArgumentTable &src, std::pmr::memory_resource *resource)
+      : m_nargs(src.m_nargs, resource), m_selves(src.m_selves, resource),
+        m_parse(src.m_parse, resource),
+        m_parse_state(src.m_parse_state, resource),
+        m_specs(src.m_specs, resource) {}
+
+  void add(IArgument::Ptr spec) {
+    const ArgumentDispatch dispatch = spec->dispatch();
+    m_nargs.push_back(spec->nargs());
+    m_selves.push_back(dispatch.self);
+    m_parse.push_back(dispatch.parse);
+    m_parse_state.push_back(dispatch.parse_state);
+    m_specs.push_back(std::move(spec));
+  }
+
+  [[nodiscard]] size_t size() const { return m_specs.size(); }
+
+  [[nodiscard]] bool empty() const { return m_specs.empty(); }
+
+  [[nodiscard]] Nargs nargs(size_t index) const { return m_nargs[index]; }
+
+  [[nodiscard]] const std::pmr::vector<IArgument::Ptr> &specs() const {
+    return m_specs;
+  }
+
+  /// Parse into the argument itself.
+  ParseResult parse(size_t index, ArgCursor &args) const {
+    return m_parse[index](m_selves[index], args);
+  }
+
+  /// Parse into state, leaving the argument untouched.
+  ParseResult parse(size_t index, ArgCursor &args, SpecState &state) const {
+    return m_parse_state[index](m_selves[index], args, state);
+  }
+
+private:
+  std::pmr::vector<Nargs> m_nargs;
+  std::pmr::vector<void *> m_selves;
+  std::pmr::vector<ArgumentDispatch::Parse> m_parse;
+  std::pmr::vector<ArgumentDispatch::ParseState> m_parse_state;
+  std::pmr::vector<IArgument::Ptr> m_specs;
+};
+} // namespace ArgParse::Internal
@@ -0,0 +1,622 @@
+#pragma once
+
+#include "arg_cursor.hpp"
+#include "help_fmt.hpp"
+#include "nargs.hpp"
+#include "output_sink.hpp"
+#include "value_converter.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A compile-time front end.  Spec names are template arguments, so a
+ * StaticParser's name lookup table and dispatch table are built by the
+ * compiler, and constructing a parser costs nothing at run time.
+ *
+ * @code
+ * using namespace ArgParse::Static;
+ * StaticParser<Flag<"-v", "--verbose", "Be verbose.">,
+ *              Option<int, "-j", "--jobs", "Number of jobs.">,
+ *              Argument<std::string, "src", Nargs::one_or_more, "Sources.">>
+ *     parser("Build some things.");
+ * parser.parse_args(argc, argv);
+ * if (parser.should_exit()) {
+ *   return parser.exit_code();
+ * }
+ * const int jobs = parser.get<"--jobs">();
+ * @endcode
+ */
+namespace ArgParse::Static {
+
+using ::ArgParse::Nargs;
+
+/**
+ * @brief A string literal that can be used as a template argument.
+ *
+ * @tparam N The size of the literal, including its terminating NUL
+ */
+template <size_t N> struct Name {
+  char m_chars[N]{};
+
+  constexpr Name(const char (&s)[N]) { std::copy_n(s, N, m_chars); }
+
+  [[nodiscard]] constexpr std::string_view view() const {
+    return {m_chars, N - 1};
+  }
+};
+
+/// The kinds of spec a StaticParser understands.
+enum class Kind { flag, option, argument };
+
+/**
+ * @brief A boolean flag, e.g., "-v|--verbose".  Its value is a bool.
+ */
+template <Name Short, Name Long, Name Help = ""> struct Flag {
+  static constexpr Kind kind = Kind::flag;
+  static constexpr std::string_view short_name = Short.view();
+  static constexpr std::string_view long_name = Long.view();
+  static constexpr std::string_view help_msg = Help.view();
+  using value_type = bool;
+};
+
+/**
+ * @brief An option with a value of type T, e.g., "-j|--jobs 4".  Its value
+ * is a T, which is value-initialized until the option is parsed.
+ */
+template <typename T, Name Short, Name Long, Name Help = ""> struct Option {
+  static constexpr Kind kind = Kind::option;
+  static constexpr std::string_view short_name = Short.view();
+  static constexpr std::string_view long_name = Long.view();
+  static constexpr std::string_view help_msg = Help.view();
+  using value_type = T;
+};
+
+/**
+ * @brief A positional argument of type T.  Its value is a T if it accepts
+ * Nargs::one value, or a std::vector<T> otherwise.
+ */
+template <typename T, Name ArgName, Nargs N, Name Help = ""> struct Argument {
+  static constexpr Kind kind = Kind::argument;
+  static constexpr std::string_view short_name = ArgName.view();
+  static constexpr std::string_view long_name = ArgName.view();
+  static constexpr std::string_view help_msg = Help.view();
+  static constexpr Nargs nargs = N;
+  using element_type = T;
+  using value_type = std::conditional_t<N == Nargs::one, T, std::vector<T>>;
+};
+
+/// FNV-1a.  Used to order and search a StaticParser's name table.
+constexpr uint64_t name_hash(std::string_view name) {
+  uint64_t result = 0xcbf29ce484222325ULL;
+  for (const char c : name) {
+    result = (result ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+  }
+  return result;
+}
+
+/**
+ * @brief Parses command-line arguments according to a fixed set of specs.
+ * Values are stored in a single aggregate inside the parser, and are
+ * accessed by spec name or by position with get().
+ *
+ * A help flag (-h|--help) is always provided.  Duplicate names are
+ * rejected at compile time.
+ *
+ * @tparam Specs Flag, Option and Argument specs
+ */
+template <typename... Specs> class StaticParser {
+  static constexpr size_t num_specs = sizeof...(Specs);
+  static constexpr size_t help_index = num_specs;
+  static constexpr size_t not_found = static_cast<size_t>(-1);
+
+  template <size_t I>
+  using SpecAt = std::tuple_element_t<I, std::tuple<Specs...>>;
+
+  static constexpr std::array<Kind, num_specs> kinds{Specs::kind...};
+  static constexpr std::array<std::string_view, num_specs> short_names{
+      Specs::short_name...};
+  static constexpr std::array<std::string_view, num_specs> long_names{
+      Specs::long_name...};
+
+  template <typename Spec> static constexpr Nargs spec_nargs() {
+    if constexpr (Spec::kind == Kind::argument) {
+      return Spec::nargs;
+    } else {
+      return Nargs::zero_or_more;
+    }
+  }
+
+  static constexpr std::array<Nargs, num_specs> nargs{spec_nargs<Specs>()...};
+
+  struct Entry {
+    uint64_t hash{0};
+    std::string_view name;
+    size_t spec{0};
+  };
+
+  // Whether an option's long name is a name of its own, i.e., is given and
+  // differs from its short name.
+  static constexpr bool has_long_name(size_t i) {
+    return !long_names[i].empty() && (long_names[i] != short_names[i]);
+  }
+
+  static constexpr size_t count_names() {
+    size_t result = 2; // -h, --help
+    for (size_t i = 0; i < num_specs; ++i) {
+      if (kinds[i] != Kind::argument) {
+        result += (short_names[i].empty() ? 0 : 1) + (has_long_name(i) ? 1 : 0);
+      }
+    }
+    return result;
+  }
+
+  static constexpr size_t num_names = count_names();
+
+  // Option names sorted by hash, for binary search.
+  static constexpr std::array<Entry, num_names> name_table = []() {
+    std::array<Entry, num_names> result;
+    size_t n = 0;
+    auto add = [&](std::string_view name, size_t spec) {
+      result[n++] = {name_hash(name), name, spec};
+    };
+    add("-h", help_index);
+    add("--help", help_index);
+    for (size_t i = 0; i < num_specs; ++i) {
+      if (kinds[i] != Kind::argument) {
+        if (!short_names[i].empty()) {
+          add(short_names[i], i);
+        }
+        if (has_long_name(i)) {
+          add(long_names[i], i);
+        }
+      }
+    }
+    std::sort(result.begin(), result.end(),
+              [](const Entry &a, const Entry &b) {
+                return (a.hash < b.hash) ||
+                       ((a.hash == b.hash) && (a.name < b.name));
+              });
+    return result;
+  }();
+
+  static constexpr bool names_are_unique() {
+    for (size_t i = 1; i < num_names; ++i) {
+      if (name_table[i].name == name_table[i - 1].name) {
+        return false;
+      }
+    }
+    return true;
+  }
+  static_assert(names_are_unique(),
+                "Each option name, including -h and --help, must be unique.");
+
+  static constexpr size_t find_option(std::string_view name) {
+    const uint64_t hash = name_hash(name);
+    auto entry =
+        std::lower_bound(name_table.begin(), name_table.end(), hash,
+                         [](const Entry &e, uint64_t h) { return e.hash < h; });
+    for (; (entry != name_table.end()) && (entry->hash == hash); ++entry) {
+      if (entry->name == name) {
+        return entry->spec;
+      }
+    }
+    return not_found;
+  }
+
+  // Find the option whose long name is name.  Only long names take
+  // "=value", so "-j=4" names no option.
+  static constexpr size_t long_option(std::string_view name) {
+    const size_t spec = find_option(name);
+    if (spec == help_index) {
+      return (name == "--help") ? spec : not_found;
+    }
+    if ((spec == not_found) || !has_long_name(spec) ||
+        (long_names[spec] != name)) {
+      return not_found;
+    }
+    return spec;
+  }
+
+  static constexpr size_t find_spec(std::string_view name) {
+    for (size_t i = 0; i < num_specs; ++i) {
+      if ((short_names[i] == name) || (long_names[i] == name)) {
+        return i;
+      }
+    }
+    return not_found;
+  }
+
+  static constexpr size_t count_args() {
+    return std::count(kinds.begin(), kinds.end(), Kind::argument);
+  }
+
+  static constexpr size_t num_args = count_args();
+
+  // Indices of the positional argument specs, in declaration order.
+  static constexpr std::array<size_t, num_args> arg_specs = []() {
+    std::array<size_t, num_args> result{};
+    size_t n = 0;
+    for (size_t i = 0; i < num_specs; ++i) {
+      if (kinds[i] == Kind::argument) {
+        result[n++] = i;
+      }
+    }
+    return result;
+  }();
+
+  // Handlers consume the current token, which has already been matched to
+  // their spec.  inline_value holds the value of a "--name=value" token.
+  using Handler = bool (*)(StaticParser &self, ArgCursor &tokens,
+                           std::optional<std::string_view> inline_value);
+
+  template <size_t I>
+  static bool handle(StaticParser &self, ArgCursor &tokens,
+                     std::optional<std::string_view> inline_value) {
+    using Spec = SpecAt<I>;
+    const std::string_view token = tokens.front();
+    tokens.pop_front();
+
+    if constexpr (Spec::kind == Kind::flag) {
+      if (inline_value) {
+        self.show_error("Unexpected value for flag: '" + std::string(token) +
+                            "'",
+                        1);
+        return false;
+      }
+      std::get<I>(self.m_values) = true;
+      ++self.m_counts[I];
+      return true;
+    } else if constexpr (Spec::kind == Kind::option) {
+      if (!inline_value) {
+        if (tokens.empty()) {
+          self.show_error("No value provided: '" + std::string(token) + "'",
+                          1);
+          return false;
+        }
+        inline_value = tokens.front();
+        tokens.pop_front();
+      }
+      if (inline_value->empty()) {
+        self.show_error("No value provided: '" + std::string(token) + "'", 1);
+        return false;
+      }
+      return self.convert(Spec::long_name, *inline_value,
+                          std::get<I>(self.m_values), I);
+    } else {
+      using T = typename Spec::element_type;
+      if constexpr (Spec::nargs == Nargs::one) {
+        return self.convert(Spec::long_name, token, std::get<I>(self.m_values),
+                            I);
+      } else {
+        T value{};
+        if (!self.convert(Spec::long_name, token, value, I)) {
+          return false;
+        }
+        std::get<I>(self.m_values).push_back(std::move(value));
+        return true;
+      }
+    }
+  }
+
+  static constexpr std::array<Handler, num_specs> handlers =
+      []<size_t... I>(std::index_sequence<I...>) {
+        return std::array<Handler, num_specs>{&handle<I>...};
+      }(std::make_index_sequence<num_specs>{});
+
+public:
+  using Values = std::tuple<typename Specs::value_type...>;
+
+  /**
+   * @brief Create a new instance.
+   *
+   * @param description Describes the purpose of the program that's parsing
+   * the command line.  The parser does not copy it.
+   */
+  constexpr explicit StaticParser(std::string_view description)
+      : m_description(description) {}
+
+  /**
+   * @brief Parse a sequence of command-line arguments.  The first argument is
+   * the name by which the executable was invoked.
+   *
+   * @param args Arguments to parse
+   */
+  void parse_args(std::span<const std::string_view> args) {
+    ArgCursor tokens(args);
+    parse(tokens);
+  }
+
+  /**
+   * @brief Parse a sequence of command-line arguments.
+   * This overload eases use from `int main(int argc, char *argv[])`.
+   *
+   * @param argc The number of command-line arguments
+   * @param argv Array of command-line arguments
+   */
+  void parse_args(int argc, char *argv[]) {
+    ArgCursor tokens(std::span<char *const>(argv, argc));
+    parse(tokens);
+  }
+
+  /**
+   * @brief Send help and error messages to a sink instead of to
+   * OutputSink::standard().
+   *
+   * @param sink Receives help and error messages
+   */
+  void set_output(OutputSink::Ptr sink) { m_output = std::move(sink); }
+
+  /**
+   * @brief Find out whether or not the program should exit.  Call this after
+   * calling parse_args.
+   */
+  [[nodiscard]] bool should_exit() const { return m_exit_code.has_value(); }
+
+  /**
+   * @brief Get the recommended exit code.  Call this after calling
+   * parse_args.
+   */
+  [[nodiscard]] int exit_code() const { return m_exit_code.value_or(0); }
+
+  /**
+   * @brief Get the value of the spec with the given short, long or
+   * positional argument name.
+   *
+   * @tparam N The name of the spec
+   * @return A reference to the spec's value.  Assigning to it before calling
+   * parse_args sets a default.
+   */
+  template <Name N> [[nodiscard]] constexpr auto &get() {
+    constexpr size_t index = find_spec(N.view());
+    static_assert(index != not_found, "No spec has this name.");
+    return std::get<index>(m_values);
+  }
+
+  template <Name N> [[nodiscard]] constexpr const auto &get() const {
+    constexpr size_t index = find_spec(N.view());
+    static_assert(index != not_found, "No spec has this name.");
+    return std::get<index>(m_values);
+  }
+
+  /**
+   * @brief Get the value of the I'th spec.
+   */
+  template <size_t I> [[nodiscard]] constexpr auto &get() {
+    return std::get<I>(m_values);
+  }
+
+  template <size_t I> [[nodiscard]] constexpr const auto &get() const {
+    return std::get<I>(m_values);
+  }
+
+  /**
+   * @brief Get the number of times the spec with the given name matched a
+   * command-line argument.
+   */
+  template <Name N> [[nodiscard]] constexpr size_t count() const {
+    constexpr size_t index = find_spec(N.view());
+    static_assert(index != not_found, "No spec has this name.");
+    return m_counts[index];
+  }
+
+  /**
+   * @brief Get all parsed values.
+   */
+  [[nodiscard]] const Values &values() const { return m_values; }
+
+  /**
+   * @brief Print a parse error message, followed by usage, to this parser's
+   * output sink.
+   *
+   * @param msg The error message to print
+   * @param exit_code The recommended exit code for this error
+   */
+  void show_error(std::string_view msg, int exit_code) {
+    std::string text;
+    text.append("Error: ").append(msg).append("\n");
+    append_usage(text);
+    output().write(OutputSink::Stream::err, text);
+    m_exit_code = exit_code;
+  }
+
+private:
+  std::string_view m_description;
+  // Null until set_output is called.
+  OutputSink::Ptr m_output;
+  std::string_view m_invoked_as;
+  Values m_values;
+  std::array<size_t, num_specs> m_counts{};
+  std::optional<int> m_exit_code;
+
+  template <typename T>
+  bool convert(std::string_view name, std::string_view sval, T &dest,
+               size_t index) {
+    Internal::ValueConverter<T> converter(name, sval);
+    if (converter.failed()) {
+      show_error(converter.error_msg().value(), 1);
+      return false;
+    }
+    dest = std::move(converter.m_value);
+    ++m_counts[index];
+    return true;
+  }
+
+  // Find the next positional spec that can accept a value.
+  [[nodiscard]] size_t next_arg_spec(size_t first) const {
+    for (size_t i = first; i < num_args; ++i) {
+      const size_t spec = arg_specs[i];
+      if ((nargs[spec] != Nargs::one) || (m_counts[spec] == 0)) {
+        return i;
+      }
+    }
+    return num_args;
+  }
+
+  void parse(ArgCursor &tokens) {
+    if (tokens.empty()) {
+      show_error("Internal Error: empty args vector", 2);
+      return;
+    }
+    m_invoked_as = tokens.front();
+    tokens.pop_front();
+
+    size_t arg_pos = 0;
+    while (!tokens.empty()) {
+      const std::string_view token = tokens.front();
+      if (token.starts_with("-")) {
+        std::optional<std::string_view> inline_value;
+        size_t spec = find_option(token);
+        const auto eq_pos = token.find('=');
+        if ((spec == not_found) && (eq_pos != std::string_view::npos)) {
+          spec = long_option(token.substr(0, eq_pos));
+          inline_value = token.substr(eq_pos + 1);
+        }
+
+        if (spec == help_index) {
+          show_help();
+          return;
+        }
+        if (spec == not_found) {
+          show_error("Unknown option '" + std::string(token) + "'", 1);
+          return;
+        }
+        if (!handlers[spec](*this, tokens, inline_value)) {
+          return;
+        }
+        continue;
+      }
+
+      arg_pos = next_arg_spec(arg_pos);
+      if (arg_pos >= num_args) {
+        report_unused_args(tokens);
+        return;
+      }
+      if (!handlers[arg_specs[arg_pos]](*this, tokens, {})) {
+        return;
+      }
+    }
+    validate_arg_specs();
+  }
+
+  void report_unused_args(ArgCursor &tokens) {
+    std::string msg("Unsupported argument(s):");
+    for (; !tokens.empty(); tokens.pop_front()) {
+      msg += " ";
+      msg += tokens.front();
+    }
+    show_error(msg, 1);
+  }
+
+  void validate_arg_specs() {
+    for (const size_t spec : arg_specs) {
+      const Nargs spec_nargs = nargs[spec];
+      const size_t count = m_counts[spec];
+      const bool complete =
+          (spec_nargs == Nargs::zero_or_more) ||
+          ((spec_nargs == Nargs::one) && (count == 1)) ||
+          ((spec_nargs == Nargs::one_or_more) && (count > 0));
+      if (!complete) {
+        show_error("Wrong number of value(s) for required parameter '" +
+                       Internal::arg_usage_str(long_names[spec], spec_nargs) +
+                       "'.  Expected " +
+                       ((spec_nargs == Nargs::one) ? "1" : ">= 1") + ", got " +
+                       std::to_string(m_counts[spec]),
+                   1);
+        return;
+      }
+    }
+  }
+
+  void show_help() {
+    std::string text;
+    text.append(m_description).append("\n");
+    append_usage(text);
+    output().write(OutputSink::Stream::out, text);
+    m_exit_code = 0;
+  }
+
+  [[nodiscard]] OutputSink &output() const {
+    if (!m_output) {
+      return *OutputSink::standard();
+    }
+    return *m_output;
+  }
+
+  template <size_t I> static std::string spec_usage() {
+    using Spec = SpecAt<I>;
+    if constexpr (Spec::kind == Kind::flag) {
+      return Internal::flag_usage_str(Spec::short_name, Spec::long_name);
+    } else if constexpr (Spec::kind == Kind::option) {
+      return Internal::option_usage_str(Spec::short_name, Spec::long_name);
+    } else {
+      return Internal::arg_usage_str(Spec::long_name, Spec::nargs);
+    }
+  }
+
+  template <size_t I> static std::string spec_help() {
+    using Spec = SpecAt<I>;
+    if constexpr (Spec::kind == Kind::flag) {
+      return Internal::flag_help_block(Spec::short_name, Spec::long_name,
+                                       Spec::help_msg);
+    } else if constexpr (Spec::kind == Kind::option) {
+      return Internal::option_help_block(Spec::short_name, Spec::long_name,
+                                         Spec::help_msg);
+    } else {
+      return Internal::arg_help_block(Spec::long_name, Spec::nargs,
+                                      Spec::help_msg);
+    }
+  }
+
+  void append_usage(std::string &text) const {
+    const auto for_each_spec = [](auto &&fn) {
+      [&]<size_t... I>(std::index_sequence<I...>) {
+        (fn(std::integral_constant<size_t, I>{}), ...);
+      }(std::make_index_sequence<num_specs>{});
+    };
+
+    text.append("Usage: ").append(m_invoked_as).append(" ");
+    text.append(Internal::flag_usage_str("-h", "--help"));
+    for_each_spec([&](auto i) {
+      if constexpr (kinds[i] != Kind::argument) {
+        text.append(" ").append(spec_usage<i>());
+      }
+    });
+    for_each_spec([&](auto i) {
+      if constexpr (kinds[i] == Kind::argument) {
+        text.append(" ").append(spec_usage<i>());
+      }
+    });
+    text.append("\n");
+
+    std::string sections("Options:\n");
+    sections
+        .append(Internal::flag_help_block("-h", "--help",
+                                          "Show this help message and exit."))
+        .append("\n");
+    for_each_spec([&](auto i) {
+      if constexpr (kinds[i] != Kind::argument) {
+        sections.append(spec_help<i>()).append("\n");
+      }
+    });
+
+    if constexpr (num_args > 0) {
+      sections.append("Arguments:\n");
+      for_each_spec([&](auto i) {
+        if constexpr (kinds[i] == Kind::argument) {
+          sections.append(spec_help<i>()).append("\n");
+        }
+      });
+    }
+    text.append(Internal::wrap_text(sections, output().width()));
+  }
+};
+} // namespace ArgParse::Static
@@ -1,34 +1,273 @@
 #pragma once
 #include "aliases.hpp"
+#include "parse_result.hpp"
+#include <charconv>
+#include <concepts>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <string_view>
 #include <type_traits>
 
-namespace ArgParse::Internal {
+namespace ArgParse {
+
+/**
+ * @brief The outcome of converting a command-line string to a value.
+ */
+enum class Conversion {
+  /// The whole string was converted
+  ok,
+  /// The string does not start with a valid value
+  invalid,
+  /// The string starts with a valid value, but has trailing text
+  incomplete,
+  /// The string holds a value that the target type can't represent
+  out_of_range
+};
+
+/**
+ * @brief Customization point for converting command-line strings to values
+ * of type T.
+ *
+ * The library converts strings, integers, floating point values and bools
+ * without using iostreams or locales.  Other types are read with
+ * operator>> from a std::istringstream, unless ValueTraits is specialized
+ * for them:
+ *
+ * @code
+ * template <> struct ArgParse::ValueTraits<Color> {
+ *   static ArgParse::Conversion from_string(std::string_view sval,
+ *                                           Color &value);
+ * };
+ * @endcode
+ *
+ * A specialization takes precedence over the library's own conversions.
+ *
+ * @tparam T The type of value to convert to
+ */
+template <typename T> struct ValueTraits {};
+
+namespace Internal {
 
 std::string invalid_value_msg(std::string_view name, std::string_view sval);
 
 std::string incomplete_conversion_msg(std::string_view name,
                                       std::string_view sval);
 
+std::string out_of_range_msg(std::string_view name, std::string_view sval);
+
+template <typename T>
+concept HasValueTraits = requires(std::string_view sval, T &value) {
+  { ValueTraits<T>::from_string(sval, value) } -> std::same_as<Conversion>;
+};
+
+template <typename T>
+concept CharType =
+    std::same_as<T, char> || std::same_as<T, signed char> ||
+    std::same_as<T, unsigned char> || std::same_as<T, wchar_t> ||
+    std::same_as<T, char8_t> || std::same_as<T, char16_t> ||
+    std::same_as<T, char32_t>;
+
+template <typename T>
+concept Integer =
+    std::integral<T> && !std::same_as<T, bool> && !CharType<T>;
+
+inline Conversion from_chars_status(std::from_chars_result result,
+                                    const char *end) {
+  if (result.ec == std::errc::invalid_argument) {
+    return Conversion::invalid;
+  }
+  if (result.ec == std::errc::result_out_of_range) {
+    return Conversion::out_of_range;
+  }
+  return (result.ptr == end) ? Conversion::ok : Conversion::incomplete;
+}
+
+/// Skip leading whitespace, as operator>> does, so that " 5" converts.
+inline std::string_view skip_leading_space(std::string_view sval) {
+  const size_t start = sval.find_first_not_of(" \t\n\v\f\r");
+  return (start == std::string_view::npos) ? std::string_view()
+                                           : sval.substr(start);
+}
+
+/// Convert an optionally signed integer, which may have a 0x, 0o or 0b
+/// prefix.
+template <Integer T> Conversion integer_from(std::string_view sval, T &value) {
+  using Magnitude = std::make_unsigned_t<T>;
+
+  sval = skip_leading_space(sval);
+  bool negative = false;
+  if (!sval.empty() && ((sval.front() == '+') || (sval.front() == '-'))) {
+    negative = (sval.front() == '-');
+    sval.remove_prefix(1);
+  }
+
+  int base = 10;
+  if ((sval.size() > 2) && (sval[0] == '0')) {
+    switch (sval[1]) {
+    case 'x':
+    case 'X':
+      base = 16;
+      break;
+    case 'o':
+    case 'O':
+      base = 8;
+      break;
+    case 'b':
+    case 'B':
+      base = 2;
+      break;
+    default:
+      break;
+    }
+    if (base != 10) {
+      sval.remove_prefix(2);
+    }
+  }
+
+  const char *end = sval.data() + sval.size();
+  Magnitude magnitude{0};
+  const auto result = std::from_chars(sval.data(), end, magnitude, base);
+  const Conversion status = from_chars_status(result, end);
+  if (status != Conversion::ok) {
+    return status;
+  }
+
+  const auto max_magnitude =
+      static_cast<Magnitude>(std::numeric_limits<T>::max());
+  if (!negative) {
+    if (magnitude > max_magnitude) {
+      return Conversion::out_of_range;
+    }
+    value = static_cast<T>(magnitude);
+  } else if constexpr (std::is_signed_v<T>) {
+    // The most negative value's magnitude is one more than the maximum.
+    if (magnitude > max_magnitude + 1) {
+      return Conversion::out_of_range;
+    }
+    value = static_cast<T>(0 - magnitude);
+  } else {
+    if (magnitude != 0) {
+      return Conversion::out_of_range;
+    }
+    value = 0;
+  }
+  return Conversion::ok;
+}
+
+/// Convert a floating point value.  Hexadecimal values need a 0x prefix.
+template <std::floating_point T>
+Conversion float_from(std::string_view sval, T &value) {
+  sval = skip_leading_space(sval);
+  bool negative = false;
+  if (!sval.empty() && ((sval.front() == '+') || (sval.front() == '-'))) {
+    negative = (sval.front() == '-');
+    sval.remove_prefix(1);
+  }
+
+  auto format = std::chars_format::general;
+  if ((sval.size() > 2) && (sval[0] == '0') &&
+      ((sval[1] == 'x') || (sval[1] == 'X'))) {
+    format = std::chars_format::hex;
+    sval.remove_prefix(2);
+  }
+
+  // from_chars would accept a second sign.
+  if (sval.empty() || (sval.front() == '+') || (sval.front() == '-')) {
+    return Conversion::invalid;
+  }
+
+  const char *end = sval.data() + sval.size();
+  T magnitude{};
+  const auto status =
+      from_chars_status(std::from_chars(sval.data(), end, magnitude, format),
+                        end);
+  if (status == Conversion::ok) {
+    value = negative ? -magnitude : magnitude;
+  }
+  return status;
+}
+
+/// Convert an explicit boolean, which must be 0 or 1.
+inline Conversion bool_from(std::string_view sval, bool &value) {
+  sval = skip_leading_space(sval);
+  if (sval.empty() || ((sval.front() != '0') && (sval.front() != '1'))) {
+    return Conversion::invalid;
+  }
+  value = (sval.front() == '1');
+  return (sval.size() == 1) ? Conversion::ok : Conversion::incomplete;
+}
+
+/// Convert using operator>>.  This is the fallback for types with no other
+/// conversion.
+template <typename T> Conversion stream_from(std::string_view sval, T &value) {
+  std::istringstream ins{std::string(sval)};
+  ins >> value;
+  if (ins.fail()) {
+    return Conversion::invalid;
+  }
+  return ins.eof() ? Conversion::ok : Conversion::incomplete;
+}
+
+template <typename T> Conversion convert(std::string_view sval, T &value) {
+  if constexpr (HasValueTraits<T>) {
+    return ValueTraits<T>::from_string(sval, value);
+  } else if constexpr (std::is_convertible_v<std::string, T>) {
+    value = sval;
+    return Conversion::ok;
+  } else if constexpr (std::same_as<T, bool>) {
+    return bool_from(sval, value);
+  } else if constexpr (Integer<T>) {
+    return integer_from(sval, value);
+  } else if constexpr (std::floating_point<T>) {
+    return float_from(sval, value);
+  } else {
+    return stream_from(sval, value);
+  }
+}
+
+inline ParseError parse_error(Conversion status) {
+  switch (status) {
+  case Conversion::ok:
+    return ParseError::none;
+  case Conversion::incomplete:
+    return ParseError::incomplete_value;
+  case Conversion::out_of_range:
+    return ParseError::out_of_range;
+  case Conversion::invalid:
+    break;
+  }
+  return ParseError::invalid_value;
+}
+
+/// Converts a value, recording why it failed, if it did.  The failure's
+/// message is formatted only if error_msg() is called, and only while name
+/// and sval are still alive.
 template <typename T> struct ValueConverter {
-  T m_value;
-  OptErrMsg m_err_msg;
-
-  ValueConverter(std::string_view name, std::string_view sval) {
-    if constexpr (std::is_convertible_v<std::string, T>) {
-      m_value = sval;
-    } else {
-      std::istringstream ins(sval.data());
-
-      ins >> m_value;
-      if (ins.fail()) {
-        m_err_msg = invalid_value_msg(name, sval);
-      } else if (!ins.eof()) {
-        m_err_msg = incomplete_conversion_msg(name, sval);
-      }
+  T m_value{};
+  ParseError m_error;
+  std::string_view m_name;
+  std::string_view m_sval;
+
+  ValueConverter(std::string_view name, std::string_view sval)
+      : m_error(parse_error(convert(sval, m_value))), m_name(name),
+        m_sval(sval) {}
+
+  [[nodiscard]] bool failed() const { return m_error != ParseError::none; }
+
+  [[nodiscard]] OptErrMsg error_msg() const {
+    if (!failed()) {
+      return {};
+    }
+    return Internal::error_msg(m_error, m_name, m_sval);
+  }
+
+  [[nodiscard]] ParseResult as_parse_result() const {
+    if (!failed()) {
+      return ParseResult::match();
     }
+    return ParseResult::match_with_error(m_error, m_name, m_sval);
   }
 };
-} // namespace ArgParse::Internal
+} // namespace Internal
+} // namespace ArgParse
@@ -1,52 +1,937 @@
 #include "argument_parser.hpp"
+#include "allocation.hpp"
+#include "completion_cache.hpp"
+#include "config_file.hpp"
+#include "edit_distance.hpp"
+#include "env_index.hpp"
+#include "help_fmt.hpp"
 #include "i_argument.hpp"
 #include "i_option.hpp"
-#include <iostream>
+#include "name_trie.hpp"
+#include "parse_context.hpp"
+#include "response_file.hpp"
+#include "spec_table.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <filesystem>
+#include <map>
+#include <memory_resource>
+#include <optional>
 #include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace ArgParse {
 
-struct Impl : public ArgumentParser {
-  Impl(std::string_view description) : m_description(description) {
-    m_help_flag =
-        Flag::create("-h", "--help", "Show this help message and exit.");
-    m_opt_specs.push_back(m_help_flag);
+// The specs of a parser.  An ArgumentParser builds one; compile() freezes a
+// copy of it.
+struct SpecSet {
+  // Every parser's first option is its help flag.
+  static constexpr size_t help_index = 0;
+
+  // A subcommand's parser is built only when the subcommand is invoked, so
+  // help is rendered from its summary.
+  struct Subcommand {
+    std::string_view m_name;
+    std::pmr::string m_summary;
+    ArgumentParser::SubcommandFactory m_factory;
+  };
+
+  // An option's source of completion candidates.
+  struct Completion {
+    ArgumentParser::Completer m_completer;
+    std::chrono::seconds m_max_age;
+  };
+
+  SpecSet(std::string_view description, std::pmr::memory_resource *resource)
+      : m_description(description, resource), m_options(resource),
+        m_args(resource), m_opt_index(resource), m_long_names(resource),
+        m_commands(resource), m_command_index(resource),
+        m_completions(resource),
+        m_flag_bits(Internal::make_shared_in<Internal::FlagBits>(resource,
+                                                                 resource)),
+        m_config_section(resource),
+        m_output(OutputSink::standard()), m_wrap_width(m_output->width()),
+        m_discards_output(m_output->discards()), m_usage_text(resource),
+        m_env_vars(resource) {}
+
+  // Compiled parsers have no subcommands and don't complete command lines,
+  // so neither subcommands nor completers are copied.  The copy's usage text
+  // is rendered up front, and its options' environment variables are copied,
+  // so that threads parsing with a compiled parser read neither from specs
+  // that the source parser may still change.
+  SpecSet(const SpecSet &src, std::pmr::memory_resource *resource)
+      : m_description(src.m_description, resource),
+        m_options(src.m_options, resource), m_args(src.m_args, resource),
+        m_opt_index(src.m_opt_index, resource),
+        m_short_index(src.m_short_index),
+        m_long_names(src.long_names(), resource), m_long_names_valid(true),
+        m_commands(resource),
+        m_command_index(resource), m_completions(resource),
+        m_flag_bits(src.m_flag_bits),
+        m_expand_response_files(src.m_expand_response_files),
+        m_config(src.m_config),
+        m_config_section(src.m_config_section, resource),
+        m_output(src.m_output), m_wrap_width(src.m_wrap_width),
+        m_discards_output(src.m_discards_output),
+        m_usage_text(src.usage_text(), resource), m_usage_valid(true),
+        m_env_vars(resource), m_env_vars_frozen(true) {
+    m_env_vars.reserve(m_options.size());
+    for (const auto &spec : m_options.specs()) {
+      m_env_vars.emplace_back(spec->env_var());
+    }
+  }
+
+  void add_option(IOption::Ptr option) {
+    // Check both names before indexing either, so a rejected option leaves
+    // the index untouched.
+    const std::string_view short_name = option->short_name();
+    const std::string_view long_name = option->long_name();
+    for (const auto name : {short_name, long_name}) {
+      if (m_opt_index.contains(name)) {
+        throw std::invalid_argument("Duplicate option name '" +
+                                    std::string(name) + "'.");
+      }
+    }
+
+    const size_t index = m_options.size();
+    uint32_t flag_bit = Internal::OptionTable::no_bit;
+    if (auto *flag = dynamic_cast<Flag *>(option.get())) {
+      flag_bit = static_cast<uint32_t>(flag->store_in(m_flag_bits));
+    }
+    m_options.add(std::move(option), flag_bit);
+    m_usage_valid = false;
+    m_long_names_valid = false;
+    for (const auto name : {short_name, long_name}) {
+      if (!name.empty()) {
+        m_opt_index.emplace(name, index);
+      }
+    }
+    if (is_single_char_name(short_name)) {
+      m_short_index[static_cast<unsigned char>(short_name[1])] =
+          static_cast<uint32_t>(index + 1);
+    }
+  }
+
+  void add_arg(IArgument::Ptr arg) {
+    if (has_subcommands()) {
+      throw std::invalid_argument(
+          "A parser with subcommands can't have positional arguments.");
+    }
+    m_args.add(std::move(arg));
+    m_usage_valid = false;
+  }
+
+  void add_subcommand(std::string_view name, std::string_view summary,
+                      ArgumentParser::SubcommandFactory factory) {
+    if (!m_args.empty()) {
+      throw std::invalid_argument(
+          "A parser with positional arguments can't have subcommands.");
+    }
+    const auto [entry, added] =
+        m_command_index.try_emplace(std::pmr::string(name), m_commands.size());
+    if (!added) {
+      throw std::invalid_argument("Duplicate subcommand name '" +
+                                  std::string(name) + "'.");
+    }
+    m_commands.push_back(
+        {entry->first, std::pmr::string(summary, m_commands.get_allocator()),
+         std::move(factory)});
+    m_usage_valid = false;
+  }
+
+  void set_completer(const IOption::Ptr &option,
+                     ArgumentParser::Completer completer,
+                     std::chrono::seconds max_age) {
+    const auto index = find_option(option->long_name().empty()
+                                       ? option->short_name()
+                                       : option->long_name());
+    if (!index || (m_options.specs()[*index] != option)) {
+      throw std::invalid_argument("The option '" + option->usage() +
+                                  "' has not been added to this parser.");
+    }
+    m_completions.insert_or_assign(*index,
+                                   Completion{std::move(completer), max_age});
+  }
+
+  [[nodiscard]] const Completion *completion(size_t index) const {
+    const auto found = m_completions.find(index);
+    return (found == m_completions.end()) ? nullptr : &found->second;
+  }
+
+  void enable_response_files() { m_expand_response_files = true; }
+
+  // Options take values from the given section of config.
+  void set_config(std::shared_ptr<const Internal::ConfigFile> config,
+                  std::string_view section) {
+    m_config = std::move(config);
+    m_config_section = section;
+  }
+
+  [[nodiscard]] const std::shared_ptr<const Internal::ConfigFile> &
+  config() const {
+    return m_config;
+  }
+
+  [[nodiscard]] std::string_view config_section() const {
+    return m_config_section;
+  }
+
+  void set_output(OutputSink::Ptr sink) {
+    m_output = std::move(sink);
+    m_wrap_width = m_output->width();
+    m_discards_output = m_output->discards();
+    m_usage_valid = false;
+  }
+
+  [[nodiscard]] const OutputSink::Ptr &output() const { return m_output; }
+
+  [[nodiscard]] bool discards_output() const { return m_discards_output; }
+
+  [[nodiscard]] bool expands_response_files() const {
+    return m_expand_response_files;
+  }
+
+  [[nodiscard]] const Internal::OptionTable &options() const {
+    return m_options;
+  }
+
+  [[nodiscard]] const Internal::ArgumentTable &args() const { return m_args; }
+
+  [[nodiscard]] Internal::FlagBits &flag_bits() const { return *m_flag_bits; }
+
+  [[nodiscard]] const std::pmr::vector<Subcommand> &subcommands() const {
+    return m_commands;
+  }
+
+  [[nodiscard]] bool has_subcommands() const { return !m_commands.empty(); }
+
+  // The environment variable of an option.  It may be named after the
+  // option is added, so only a compiled copy keeps it in the set.
+  [[nodiscard]] std::string_view env_var(size_t index) const {
+    if (m_env_vars_frozen) {
+      return m_env_vars[index];
+    }
+    return m_options.specs()[index]->env_var();
+  }
+
+  // Whether any option takes its value from the environment.
+  [[nodiscard]] bool uses_env() const {
+    for (size_t i = 0; i < m_options.size(); ++i) {
+      if (!env_var(i).empty()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  [[nodiscard]] std::optional<size_t>
+  find_subcommand(std::string_view name) const {
+    const auto found = m_command_index.find(name);
+    if (found == m_command_index.end()) {
+      return std::nullopt;
+    }
+    return found->second;
+  }
+
+  // How an argument names an option.
+  struct OptionMatch {
+    enum class Kind { none, found, ambiguous };
+    Kind m_kind{Kind::none};
+    size_t m_index{0};
+    // The value given by "--output=value", if any.
+    std::optional<std::string_view> m_value;
+  };
+
+  // Find the index of the option with a name.
+  [[nodiscard]] std::optional<size_t> find_option(std::string_view name) const {
+    if (is_single_char_name(name)) {
+      if (const auto index = find_short(name[1])) {
+        return index;
+      }
+      // A long name may be a single character too, e.g., "-x".
+    }
+    const auto found = m_opt_index.find(name);
+    if (found == m_opt_index.end()) {
+      return std::nullopt;
+    }
+    return found->second;
+  }
+
+  // Find the option, if any, named by an argument: "-o", "--output",
+  // "--output=value", or an abbreviation of a long name that starts no
+  // other, e.g., "--out" or "--out=value".  A flag takes no value, so
+  // "--verbose=value" names no option.
+  [[nodiscard]] OptionMatch match_option(std::string_view arg) const {
+    if (const auto index = find_option(arg)) {
+      return {OptionMatch::Kind::found, *index, std::nullopt};
+    }
+
+    // Whole names are found by hashing, which beats walking the trie when
+    // there are many options.  Only abbreviations and unknown names need the
+    // walk.
+    const size_t eq_pos = arg.find('=');
+    const std::string_view name = arg.substr(0, eq_pos);
+    std::optional<size_t> index;
+    if (eq_pos != std::string_view::npos) {
+      index = find_option(name);
+    }
+    if (index) {
+      // Only long names take "=value".
+      if (m_options.long_name(*index) != name) {
+        return {};
+      }
+    } else if (is_long_name(name)) {
+      const auto match = long_names().find(name);
+      switch (match.kind) {
+      case Internal::NameTrie::Match::Kind::none:
+        return {};
+      case Internal::NameTrie::Match::Kind::ambiguous:
+        return {OptionMatch::Kind::ambiguous, 0, std::nullopt};
+      default:
+        index = match.index;
+      }
+    }
+
+    if (!index) {
+      return {};
+    }
+    if (eq_pos == std::string_view::npos) {
+      return {OptionMatch::Kind::found, *index, std::nullopt};
+    }
+    if (!m_options.takes_value(*index)) {
+      return {};
+    }
+    return {OptionMatch::Kind::found, *index, arg.substr(eq_pos + 1)};
+  }
+
+  // Find the index of the option with a single-character short name, e.g.,
+  // 'v' for "-v".
+  [[nodiscard]] std::optional<size_t> find_short(char name) const {
+    const uint32_t slot = m_short_index[static_cast<unsigned char>(name)];
+    if (slot == 0) {
+      return std::nullopt;
+    }
+    return slot - 1;
+  }
+
+  // Whether an argument is a cluster of single-character short options,
+  // e.g., "-xvf".  All but the last must be flags; an option that takes a
+  // value ends the cluster, and the rest of the argument is its value, as
+  // in "-xvfout.txt" or "-ofile", unless it starts with '='.
+  [[nodiscard]] bool is_short_cluster(std::string_view arg) const {
+    if ((arg.size() < 3) || (arg[0] != '-') || (arg[1] == '-')) {
+      return false;
+    }
+    for (size_t i = 1; i < arg.size(); ++i) {
+      const auto index = find_short(arg[i]);
+      if (!index) {
+        return false;
+      }
+      if (m_options.takes_value(*index)) {
+        // Only long names take "=value", so "-o=value" and "-xo=value" are
+        // not clusters.
+        return (i + 1 == arg.size()) || (arg[i + 1] != '=');
+      }
+    }
+    return true;
+  }
+
+  // The names nearest to that of an unknown option, sorted.  One edit is
+  // allowed for every three characters after the dashes, so a short name is
+  // never mistaken for another.
+  [[nodiscard]] std::vector<std::string_view>
+  suggestions(std::string_view arg) const {
+    const std::string_view name = arg.substr(0, arg.find('='));
+    const size_t num_dashes =
+        std::min(name.find_first_not_of('-'), name.size());
+    const size_t max_distance = (name.size() - num_dashes) / 3;
+    if (max_distance == 0) {
+      return {};
+    }
+    std::vector<std::string_view> names;
+    names.reserve(2 * m_options.size());
+    for (size_t i = 0; i < m_options.size(); ++i) {
+      for (const auto spec_name :
+           {m_options.short_name(i), m_options.long_name(i)}) {
+        if (!spec_name.empty()) {
+          names.push_back(spec_name);
+        }
+      }
+    }
+    return Internal::nearest_names(name, names, max_distance);
+  }
+
+  // The long names that an ambiguous abbreviation could stand for, sorted.
+  [[nodiscard]] std::vector<std::string_view>
+  expansions(std::string_view abbreviation) const {
+    std::vector<std::string_view> result;
+    for (const size_t index : long_names().find_all(abbreviation)) {
+      result.push_back(m_options.long_name(index));
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+  // command_path is the invocation of the parent parser, if any, e.g., "git"
+  // for "git commit".
+  // Each message is assembled in full, then written at once.
+  void show_error(std::string_view command_path, std::string_view invoked_as,
+                  std::string_view message) const {
+    std::string text;
+    text.append("Error: ").append(message).append("\n");
+    append_usage(text, command_path, invoked_as);
+    m_output->write(OutputSink::Stream::err, text);
+  }
+
+  void show_help(std::string_view command_path,
+                 std::string_view invoked_as) const {
+    std::string text;
+    text.append(m_description).append("\n");
+    append_usage(text, command_path, invoked_as);
+    m_output->write(OutputSink::Stream::out, text);
   }
 
-  void add_option(IOption::Ptr option) override {
-    m_opt_specs.push_back(option);
+private:
+  static bool is_single_char_name(std::string_view name) {
+    return (name.size() == 2) && (name[0] == '-') && (name[1] != '-');
+  }
+
+  // Long names, which may be abbreviated, are those that start with "--".
+  static bool is_long_name(std::string_view name) {
+    return (name.size() > 2) && name.starts_with("--");
+  }
+
+  // The trie is built when first needed, once the options have been added,
+  // so that its nodes lie together rather than among the specs.
+  [[nodiscard]] const Internal::NameTrie &long_names() const {
+    if (!m_long_names_valid) {
+      m_long_names.clear();
+      m_long_names.reserve(m_options.size());
+      for (size_t i = 0; i < m_options.size(); ++i) {
+        const std::string_view long_name = m_options.long_name(i);
+        if (is_long_name(long_name)) {
+          m_long_names.insert(long_name, i);
+        }
+      }
+      m_long_names_valid = true;
+    }
+    return m_long_names;
+  }
+
+  void append_usage(std::string &text, std::string_view command_path,
+                    std::string_view invoked_as) const {
+    const std::string_view usage = usage_text();
+    text.reserve(text.size() + command_path.size() + invoked_as.size() +
+                 usage.size() + 8);
+    text.append("Usage: ");
+    if (!command_path.empty()) {
+      text.append(command_path).append(" ");
+    }
+    text.append(invoked_as).append(usage);
+  }
+
+  // Everything that append_usage writes after the command name.  Formatting
+  // the usage and help of every spec is costly, so this is rendered when
+  // first needed and again only after specs are added or any option's
+  // environment variable changes.
+  [[nodiscard]] const std::pmr::string &usage_text() const {
+    if (!m_usage_valid || env_vars_changed()) {
+      render_usage_text();
+      m_usage_valid = true;
+      record_env_vars();
+    }
+    return m_usage_text;
+  }
+
+  // Whether any option's environment variable has changed since the usage
+  // text was rendered.
+  [[nodiscard]] bool env_vars_changed() const {
+    if (m_env_vars_frozen) {
+      return false;
+    }
+    if (m_env_vars.size() != m_options.size()) {
+      return true;
+    }
+    for (size_t i = 0; i < m_options.size(); ++i) {
+      if (m_env_vars[i] != m_options.specs()[i]->env_var()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void record_env_vars() const {
+    m_env_vars.clear();
+    for (const auto &spec : m_options.specs()) {
+      m_env_vars.emplace_back(spec->env_var());
+    }
+  }
+
+  void render_usage_text() const {
+    auto &text = m_usage_text;
+    text.clear();
+    for (const auto &spec : m_options.specs()) {
+      text.append(" ").append(spec->usage());
+    }
+    for (const auto &spec : m_args.specs()) {
+      text.append(" ").append(spec->usage());
+    }
+    if (has_subcommands()) {
+      text.append(" ").append(Internal::command_usage_str());
+    }
+    text.append("\n");
+
+    // The synopsis above is left unwrapped; the descriptions of the specs
+    // are wrapped to the output's width.
+    std::string sections;
+    if (!m_options.empty()) {
+      sections.append("Options:\n");
+      for (const auto &spec : m_options.specs()) {
+        sections.append(spec->help()).append("\n");
+      }
+    }
+
+    if (!m_args.empty()) {
+      sections.append("Arguments:\n");
+      for (const auto &spec : m_args.specs()) {
+        sections.append(spec->help()).append("\n");
+      }
+    }
+
+    if (has_subcommands()) {
+      sections.append("Commands:\n");
+      for (const auto &command : m_commands) {
+        sections
+            .append(Internal::command_help_block(command.m_name,
+                                                 command.m_summary))
+            .append("\n");
+      }
+    }
+    text.append(Internal::wrap_text(sections, m_wrap_width));
+  }
+
+  std::pmr::string m_description;
+  // Parsing reads the specs' names and calls them through these tables.
+  Internal::OptionTable m_options;
+  Internal::ArgumentTable m_args;
+
+  // Maps each short and long option name to the index of its spec.  The keys
+  // view names owned by the specs.
+  std::pmr::unordered_map<std::string_view, size_t> m_opt_index;
+  // Indexes single-character short names directly, by character.  Each
+  // entry is one more than the option's index, or 0 for none.
+  std::array<uint32_t, 256> m_short_index{};
+  // The long names again, so that they can be abbreviated.
+  mutable Internal::NameTrie m_long_names;
+  mutable bool m_long_names_valid{false};
+
+  // Subcommands in the order they were added, and the index of each by name.
+  // The subcommands' names view the index's keys.
+  std::pmr::vector<Subcommand> m_commands;
+  std::pmr::map<std::pmr::string, size_t, std::less<>> m_command_index;
+
+  // Completion sources, by option index.
+  std::pmr::unordered_map<size_t, Completion> m_completions;
+
+  // The states of the flags added to this set.  Compiled parsers keep flag
+  // states in their ParseContexts instead.
+  Internal::FlagBits::Ptr m_flag_bits;
+
+  bool m_expand_response_files{false};
+
+  // The config file, if any, shared with subcommands and compiled
+  // snapshots.  Parsed values may view it.
+  std::shared_ptr<const Internal::ConfigFile> m_config;
+  std::pmr::string m_config_section;
+
+  OutputSink::Ptr m_output;
+  size_t m_wrap_width;
+  bool m_discards_output;
+
+  mutable std::pmr::string m_usage_text;
+  mutable bool m_usage_valid{false};
+  // The options' environment variables: in a compiled copy, as they were
+  // when it was compiled; otherwise, as they were when the usage text was
+  // rendered.
+  mutable std::pmr::vector<std::pmr::string> m_env_vars;
+  bool m_env_vars_frozen{false};
+};
+
+struct Impl;
+
+// Parses into the specs themselves.
+struct SpecTarget {
+  Impl &m_parser;
+  const SpecSet &m_specs;
+
+  ParseResult parse_option_value(size_t index, std::string_view source,
+                                 std::string_view value) const {
+    return m_specs.options().parse_value(index, source, value);
+  }
+
+  // A flag added to a parser keeps its state in the parser's FlagBits, so
+  // setting it needs no call, unless it has since been added to another
+  // parser.
+  ParseResult set_flag(size_t index, std::string_view name) const {
+    const uint32_t bit = m_specs.options().flag_bit(index);
+    if ((bit == Internal::OptionTable::no_bit) ||
+        !m_specs.flag_bits().holds(bit)) {
+      return parse_option_value(index, name, "true");
+    }
+    m_specs.flag_bits().set(bit, true);
+    return ParseResult::match();
+  }
+
+  ParseResult parse_arg(size_t index, ArgCursor &args) const {
+    return m_specs.args().parse(index, args);
+  }
+
+  [[nodiscard]] OptErrMsg finish_arg(size_t index) const {
+    return m_specs.args().specs()[index]->finish();
+  }
+
+  void discard_pending(size_t index) const {
+    m_specs.args().specs()[index]->discard_pending();
+  }
+
+  [[nodiscard]] size_t num_values(size_t arg_index) const {
+    return m_specs.args().specs()[arg_index]->num_values();
+  }
+
+  [[nodiscard]] bool help_requested() const {
+    return m_specs.flag_bits().test(
+        m_specs.options().flag_bit(SpecSet::help_index));
+  }
+
+  // Parse the remaining args with a subcommand's parser, returning its exit
+  // code, if any.
+  std::optional<int> parse_subcommand(size_t index,
+                                      std::string_view command_path,
+                                      std::string_view invoked_as,
+                                      ArgCursor &args) const;
+};
+
+// Parses into per-parse state, leaving the specs untouched.
+struct StateTarget {
+  const SpecSet &m_specs;
+  std::span<SpecState> m_opt_states;
+  std::span<SpecState> m_arg_states;
+
+  ParseResult parse_option_value(size_t index, std::string_view source,
+                                 std::string_view value) const {
+    return m_specs.options().parse_value(index, source, value,
+                                         m_opt_states[index]);
+  }
+
+  // The state of a Flag is a bool.
+  ParseResult set_flag(size_t index, std::string_view name) const {
+    if (m_specs.options().flag_bit(index) == Internal::OptionTable::no_bit) {
+      return parse_option_value(index, name, "true");
+    }
+    std::any_cast<bool &>(m_opt_states[index]) = true;
+    return ParseResult::match();
+  }
+
+  ParseResult parse_arg(size_t index, ArgCursor &args) const {
+    return m_specs.args().parse(index, args, m_arg_states[index]);
   }
 
-  void add_arg(IArgument::Ptr arg) override { m_arg_specs.push_back(arg); }
+  [[nodiscard]] OptErrMsg finish_arg(size_t index) const {
+    return m_specs.args().specs()[index]->finish(m_arg_states[index]);
+  }
+
+  void discard_pending(size_t index) const {
+    m_specs.args().specs()[index]->discard_pending(m_arg_states[index]);
+  }
+
+  [[nodiscard]] size_t num_values(size_t arg_index) const {
+    return m_specs.args().specs()[arg_index]->num_values(
+        m_arg_states[arg_index]);
+  }
+
+  [[nodiscard]] bool help_requested() const {
+    return std::any_cast<bool>(m_opt_states[SpecSet::help_index]);
+  }
+
+  // Compiled parsers have no subcommands.
+  std::optional<int> parse_subcommand(size_t, std::string_view,
+                                      std::string_view, ArgCursor &) const {
+    return std::nullopt;
+  }
+};
+
+// One parse of a sequence of arguments.  Target determines where the results
+// are stored: SpecTarget or StateTarget.
+template <typename Target> class ParseRun {
+public:
+  // env is null if no option uses the environment.  command_path is the
+  // invocation of the parent parser, if this parses a subcommand.
+  ParseRun(const SpecSet &specs, const Target &target,
+           std::optional<int> &exit_code, const Internal::EnvIndex *env,
+           std::string_view command_path = {})
+      : m_specs(specs), m_target(target), m_exit_code(exit_code), m_env(env),
+        m_command_path(command_path) {}
+
+  // Parse args, first expanding any response files into response_files, if
+  // the specs allow it.
+  void parse(ArgCursor &mut_args, Internal::ResponseFiles &response_files) {
+    if (m_specs.expands_response_files() &&
+        Internal::ResponseFiles::any_in(mut_args)) {
+      m_invoked_as = mut_args.front();
+      if (auto err_msg = response_files.expand(mut_args)) {
+        show_error(err_msg.value(), 1);
+        return;
+      }
+      ArgCursor expanded(response_files.args());
+      parse(expanded);
+    } else {
+      parse(mut_args);
+    }
+    if (m_exit_code) {
+      discard_pending_args();
+    }
+  }
+
+  [[nodiscard]] std::string_view invoked_as() const { return m_invoked_as; }
 
 private:
-  void consume_cmd_name(ArgSeq &mut_args) {
+  const SpecSet &m_specs;
+  const Target &m_target;
+  std::optional<int> &m_exit_code;
+  const Internal::EnvIndex *const m_env;
+  const std::string_view m_command_path;
+  std::string_view m_invoked_as;
+
+  // Options given invalid values by the environment or by the config file.
+  // These are errors only if the options aren't given on the command line.
+  std::vector<std::pair<size_t, ParseResult>> m_fallback_errors;
+
+  void parse(ArgCursor &mut_args) {
+    if (mut_args.empty()) {
+      show_error("Internal Error: empty args vector", 2);
+      return;
+    }
+
+    consume_cmd_name(mut_args);
+    parse_fallbacks();
+
+    while (!mut_args.empty()) {
+      // Allow interleaving options with positional args...
+      bool did_match = consume_option(mut_args) || consume_arg(mut_args);
+
+      // Bail as soon as a help flag is encountered.
+      if (m_target.help_requested()) {
+        m_specs.show_help(m_command_path, m_invoked_as);
+        m_exit_code = 0;
+        return;
+      }
+
+      if (!did_match && !mut_args.empty()) {
+        if (m_specs.has_subcommands() && !m_exit_code) {
+          consume_subcommand(mut_args);
+        } else {
+          report_unused_args(mut_args);
+        }
+        return;
+      }
+    }
+    if (!m_fallback_errors.empty() && !m_exit_code) {
+      const ParseResult &result = m_fallback_errors.front().second;
+      report(1, [&result] { return result.error_msg().value(); });
+      return;
+    }
+    if (m_specs.has_subcommands() && !m_exit_code) {
+      show_error("Missing command.", 1);
+      return;
+    }
+    if (finish_arg_specs()) {
+      validate_arg_specs();
+    }
+  }
+
+  void show_error(std::string_view message, int exit_code) {
+    report(exit_code, [message] { return message; });
+  }
+
+  // Record an error.  Its message is formatted only if it will be shown, so
+  // rejected parses cost little when output is discarded.
+  template <typename Format> void report(int exit_code, const Format &format) {
+    m_exit_code = exit_code;
+    if (!m_specs.discards_output()) {
+      m_specs.show_error(m_command_path, m_invoked_as, format());
+    }
+  }
+
+  // Give options their values from the config file, then from the
+  // environment.  Options given on the command line are parsed afterwards,
+  // so they take precedence.
+  void parse_fallbacks() {
+    const Internal::ConfigFile *config = m_specs.config().get();
+    if ((config == nullptr) && (m_env == nullptr)) {
+      return;
+    }
+    const Internal::OptionTable &options = m_specs.options();
+    for (size_t i = 0; i < options.size(); ++i) {
+      if (config != nullptr) {
+        const std::string_view key = config_key(options.long_name(i));
+        if (!key.empty()) {
+          if (const auto value = config->find(m_specs.config_section(), key)) {
+            parse_fallback(i, key, *value);
+          }
+        }
+      }
+      if (m_env == nullptr) {
+        continue;
+      }
+      const std::string_view env_var = m_specs.env_var(i);
+      if (!env_var.empty()) {
+        if (const auto value = m_env->find(env_var)) {
+          parse_fallback(i, env_var, *value);
+        }
+      }
+    }
+  }
+
+  // An option's config key is its long name without the leading dashes.
+  static std::string_view config_key(std::string_view long_name) {
+    while (long_name.starts_with('-')) {
+      long_name.remove_prefix(1);
+    }
+    return long_name;
+  }
+
+  // Only the last value given to an option matters.
+  void parse_fallback(size_t index, std::string_view source,
+                      std::string_view value) {
+    const auto result = m_target.parse_option_value(index, source, value);
+    std::erase_if(m_fallback_errors,
+                  [index](const auto &error) { return error.first == index; });
+    if (result.has_error()) {
+      m_fallback_errors.emplace_back(index, result);
+    }
+  }
+
+  void consume_cmd_name(ArgCursor &mut_args) {
     m_invoked_as = mut_args.front();
     mut_args.pop_front();
   }
 
-  bool consume_option(ArgSeq &mut_args) {
-    for (auto spec : m_opt_specs) {
-      auto parse_result = spec->parse(mut_args);
-      if (parse_result.matched()) {
-        return process_parse_result(parse_result);
-      }
+  bool consume_option(ArgCursor &mut_args) {
+    if (mut_args.empty()) {
+      return false;
     }
-    // No option matched.  Unknown option?
-    if (!mut_args.empty()) {
-      std::string arg(mut_args.front());
+
+    const std::string_view arg = mut_args.front();
+    const auto match = m_specs.match_option(arg);
+    switch (match.m_kind) {
+    case SpecSet::OptionMatch::Kind::none:
+      if (m_specs.is_short_cluster(arg)) {
+        mut_args.pop_front();
+        return consume_short_cluster(arg, mut_args);
+      }
+      // Unknown option?
       if (arg.starts_with("-")) {
-        show_error("Unknown option '" + arg + "'", 1);
+        report(1, [this, arg] { return unknown_option_msg(arg); });
+      }
+      return false;
+    case SpecSet::OptionMatch::Kind::ambiguous:
+      report(1, [this, arg] { return ambiguous_option_msg(arg); });
+      return false;
+    case SpecSet::OptionMatch::Kind::found:
+      break;
+    }
+
+    mut_args.pop_front();
+    // "--output=" gives no value; "--output ''" gives an empty one.
+    if (match.m_value && match.m_value->empty()) {
+      return process_parse_result(ParseResult::match_with_error(
+          ParseError::missing_value, arg, arg));
+    }
+    return consume_option_value(match.m_index, arg, match.m_value, mut_args);
+  }
+
+  // Parse a cluster of single-character short options, e.g., "-xvf".  All
+  // but the last are flags.  The last may take its value from the rest of
+  // the cluster, as in "-xvfout.txt", or from the next argument.
+  bool consume_short_cluster(std::string_view cluster, ArgCursor &mut_args) {
+    for (size_t i = 1; i < cluster.size(); ++i) {
+      const size_t index = m_specs.find_short(cluster[i]).value();
+      // Errors name the option within the cluster, e.g., "-f".
+      const std::string_view name = m_specs.options().short_name(index);
+      if (m_specs.options().takes_value(index)) {
+        std::optional<std::string_view> value;
+        if (i + 1 < cluster.size()) {
+          value = cluster.substr(i + 1);
+        }
+        return consume_option_value(index, name, value, mut_args);
+      }
+      if (!consume_option_value(index, name, std::nullopt, mut_args)) {
         return false;
       }
     }
-    return false;
+    return true;
   }
 
-  bool consume_arg(ArgSeq &mut_args) {
-    for (auto spec : m_arg_specs) {
-      auto parse_result = spec->parse(mut_args);
+  // Give an option its value: value, if given with the option's name, or
+  // else the next argument.  The name has already been matched, perhaps
+  // abbreviated, so the spec is given only the value.  name is the option
+  // as given, for error messages.
+  bool consume_option_value(size_t index, std::string_view name,
+                            std::optional<std::string_view> value,
+                            ArgCursor &mut_args) {
+    if (!m_fallback_errors.empty()) {
+      std::erase_if(m_fallback_errors, [index](const auto &error) {
+        return error.first == index;
+      });
+    }
+    // A flag is set by its name alone.
+    if (!m_specs.options().takes_value(index)) {
+      return process_parse_result(m_target.set_flag(index, name));
+    }
+    if (!value) {
+      if (mut_args.empty()) {
+        return process_parse_result(ParseResult::match_with_error(
+            ParseError::missing_value, name, name));
+      }
+      value = mut_args.front();
+      mut_args.pop_front();
+    }
+    return process_parse_result(
+        m_target.parse_option_value(index, name, *value));
+  }
+
+  std::string unknown_option_msg(std::string_view arg) const {
+    std::string msg = "Unknown option '" + std::string(arg) + "'";
+    const auto suggestions = m_specs.suggestions(arg);
+    if (!suggestions.empty()) {
+      append_names(msg.append(" (did you mean"), suggestions).append("?)");
+    }
+    return msg;
+  }
+
+  std::string ambiguous_option_msg(std::string_view arg) const {
+    const std::string_view name = arg.substr(0, arg.find('='));
+    std::string msg = "Ambiguous option '" + std::string(arg) + "' (could be";
+    return append_names(msg, m_specs.expansions(name)).append(")");
+  }
+
+  static std::string &append_names(std::string &msg,
+                                   const std::vector<std::string_view> &names) {
+    const char *separator = " ";
+    for (const auto name : names) {
+      msg.append(separator).append(name);
+      separator = ", ";
+    }
+    return msg;
+  }
+
+  bool consume_arg(ArgCursor &mut_args) {
+    for (size_t i = 0; i < m_specs.args().size(); ++i) {
+      auto parse_result = m_target.parse_arg(i, mut_args);
       if (parse_result.matched()) {
         return process_parse_result(parse_result);
       }
@@ -54,27 +939,44 @@ private:
     return false;
   }
 
+  // The subcommand consumes all remaining args.
+  void consume_subcommand(ArgCursor &mut_args) {
+    const std::string_view name = mut_args.front();
+    const auto index = m_specs.find_subcommand(name);
+    if (!index) {
+      report(1,
+             [name] { return "Unknown command '" + std::string(name) + "'"; });
+      return;
+    }
+    if (auto exit_code = m_target.parse_subcommand(*index, m_command_path,
+                                                   m_invoked_as, mut_args)) {
+      m_exit_code = exit_code;
+    }
+  }
+
   bool process_parse_result(const ParseResult &parse_result) {
-    if (parse_result.error_msg()) {
-      show_error(parse_result.error_msg().value(), 1);
+    if (parse_result.has_error()) {
+      report(1, [&parse_result] { return parse_result.error_msg().value(); });
       return false;
     }
     return true;
   }
 
-  void report_unused_args(ArgSeq &mut_args) {
-    std::ostringstream outs;
-    outs << "Unsupported argument(s):";
-    for (const auto arg : mut_args) {
-      outs << " " << arg;
+  void report_unused_args(ArgCursor &mut_args) {
+    report(1, [unused = mut_args] {
+      std::string msg("Unsupported argument(s):");
+      for (ArgCursor rest = unused; !rest.empty(); rest.pop_front()) {
+        msg.append(" ").append(rest.front());
+      }
+      return msg;
+    });
+    while (!mut_args.empty()) {
+      mut_args.pop_front();
     }
-
-    std::string msg(outs.str());
-    show_error(msg, 1);
   }
 
-  std::string expected_arg_count(IArgument::Ptr const spec) {
-    switch (spec->nargs()) {
+  static std::string expected_arg_count(Nargs nargs) {
+    switch (nargs) {
     case Nargs::one:
       return "1";
     case Nargs::zero_or_more:
@@ -87,53 +989,205 @@ private:
     return "?";
   }
 
+  // Drop any conversions that the arg specs deferred, when parsing stops
+  // before they are completed.
+  void discard_pending_args() {
+    for (size_t i = 0; i < m_specs.args().size(); ++i) {
+      m_target.discard_pending(i);
+    }
+  }
+
+  // Complete any conversions that the arg specs deferred.
+  bool finish_arg_specs() {
+    for (size_t i = 0; i < m_specs.args().size(); ++i) {
+      if (auto err_msg = m_target.finish_arg(i)) {
+        show_error(err_msg.value(), 1);
+        return false;
+      }
+    }
+    return true;
+  }
+
   void validate_arg_specs() {
-    for (auto spec : m_arg_specs) {
-      if (!spec->is_complete()) {
-        std::ostringstream outs;
-        outs << "Wrong number of value(s) for required parameter '"
-             << spec->usage() << "'.  Expected " << expected_arg_count(spec)
-             << ", got " << spec->num_values() << std::endl;
-        show_error(outs.str(), 1);
+    const Internal::ArgumentTable &args = m_specs.args();
+    for (size_t i = 0; i < args.size(); ++i) {
+      const Nargs nargs = args.nargs(i);
+      const size_t num_values = m_target.num_values(i);
+      if (!Internal::nargs_satisfied(nargs, num_values)) {
+        report(1, [&spec = *args.specs()[i], nargs, num_values] {
+          std::ostringstream outs;
+          outs << "Wrong number of value(s) for required parameter '"
+               << spec.usage() << "'.  Expected " << expected_arg_count(nargs)
+               << ", got " << num_values << std::endl;
+          return outs.str();
+        });
         return;
       }
     }
   }
+};
 
-public:
-  void parse_args(int argc, char *argv[]) override {
-    ArgSeq args;
-    for (int i = 0; i < argc; ++i) {
-      args.push_back(argv[i]);
+struct CompiledImpl : public CompiledParser {
+  CompiledImpl(const SpecSet &specs, std::pmr::memory_resource *resource)
+      : m_specs(specs, resource), m_slots(index_slots(m_specs, resource)),
+        m_env(index_env(m_specs, resource)) {}
+
+private:
+  const SpecSet m_specs;
+  const std::shared_ptr<const Internal::SpecSlots> m_slots;
+  // The environment is read once, when the snapshot is taken.
+  const std::shared_ptr<const Internal::EnvIndex> m_env;
+
+  static std::shared_ptr<const Internal::EnvIndex>
+  index_env(const SpecSet &specs, std::pmr::memory_resource *resource) {
+    if (!specs.uses_env()) {
+      return nullptr;
     }
-    parse_args(args);
+    return Internal::make_shared_in<Internal::EnvIndex>(resource, resource);
   }
 
-  void parse_args(const ArgSeq &args) override {
-    if (args.empty()) {
-      show_error("Internal Error: empty args vector", 2);
-      return;
+  // The initial states are taken now, so that a parse neither calls the
+  // specs to build them nor sees defaults changed after compilation.
+  static std::shared_ptr<const Internal::SpecSlots>
+  index_slots(const SpecSet &specs, std::pmr::memory_resource *resource) {
+    auto slots = Internal::make_shared_in<Internal::SpecSlots>(resource,
+                                                               resource);
+    const size_t num_options = specs.options().size();
+    const size_t num_args = specs.args().size();
+    slots->options.reserve(num_options);
+    slots->arguments.reserve(num_args);
+    slots->initial_states.reserve(num_options + num_args);
+    for (size_t i = 0; i < num_options; ++i) {
+      const auto &spec = specs.options().specs()[i];
+      slots->options.emplace(spec.get(), i);
+      slots->initial_states.push_back(spec->initial_state());
+    }
+    for (size_t i = 0; i < num_args; ++i) {
+      const auto &spec = specs.args().specs()[i];
+      slots->arguments.emplace(spec.get(), num_options + i);
+      slots->initial_states.push_back(spec->initial_state());
     }
+    slots->num_options = num_options;
+    return slots;
+  }
 
-    ArgSeq mut_args(args);
-    consume_cmd_name(mut_args);
+  [[nodiscard]] ParseContext
+  parse(ArgCursor &mut_args,
+        std::pmr::memory_resource *resource) const override {
+    ParseContext context(m_slots, resource);
+    const StateTarget target{m_specs, context.option_states(),
+                             context.argument_states()};
+    ParseRun<StateTarget>(m_specs, target, context.m_exit_code, m_env.get())
+        .parse(mut_args, context.m_response_files);
+    return context;
+  }
+};
 
-    while (!mut_args.empty()) {
-      // Allow interleaving options with positional args...
-      bool did_match = consume_option(mut_args) || consume_arg(mut_args);
+struct Impl : public ArgumentParser {
+  Impl(std::string_view description, std::pmr::memory_resource *resource)
+      : m_resource(resource), m_specs(description, resource),
+        m_invoked_as(resource), m_command_path(resource),
+        m_subparsers(resource), m_arg_buffer(resource),
+        m_response_files(resource) {
+    add_option(Flag::create("-h", "--help", "Show this help message and exit.",
+                            resource));
+  }
 
-      // Bail as soon as a help flag is encountered.
-      if (m_help_flag->is_set()) {
-        show_help();
-        return;
+  [[nodiscard]] std::pmr::memory_resource *resource() const override {
+    return m_resource;
+  }
+
+  void add_option(IOption::Ptr option) override { m_specs.add_option(option); }
+
+  void add_arg(IArgument::Ptr arg) override { m_specs.add_arg(arg); }
+
+  void add_subcommand(std::string_view name, std::string_view summary,
+                      SubcommandFactory factory) override {
+    m_specs.add_subcommand(name, summary, std::move(factory));
+    m_subparsers.emplace_back();
+  }
+
+  [[nodiscard]] std::string_view subcommand() const override {
+    if (!m_subcommand) {
+      return {};
+    }
+    return m_specs.subcommands()[*m_subcommand].m_name;
+  }
+
+  [[nodiscard]] Ptr subparser() const override {
+    if (!m_subcommand) {
+      return nullptr;
+    }
+    return m_subparsers[*m_subcommand];
+  }
+
+  void set_completer(const IOption::Ptr &option, Completer completer,
+                     std::chrono::seconds max_age) override {
+    m_specs.set_completer(option, std::move(completer), max_age);
+  }
+
+  void enable_response_files() override { m_specs.enable_response_files(); }
+
+  OptErrMsg load_config(std::string_view path) override {
+    auto config =
+        Internal::make_shared_in<Internal::ConfigFile>(m_resource, m_resource);
+    if (auto err_msg = config->load(path)) {
+      return err_msg;
+    }
+    use_config(std::move(config), {});
+    return {};
+  }
+
+  void set_output(OutputSink::Ptr sink) override {
+    for (const auto &subparser : m_subparsers) {
+      if (subparser) {
+        subparser->set_output(sink);
       }
+    }
+    m_specs.set_output(std::move(sink));
+  }
 
-      if (!did_match && !mut_args.empty()) {
-        report_unused_args(mut_args);
-        return;
+  [[nodiscard]] CompiledParser::Ptr compile() const override {
+    if (m_specs.has_subcommands()) {
+      throw std::invalid_argument(
+          "A parser with subcommands can't be compiled.");
+    }
+    return Internal::make_shared_in<CompiledImpl>(m_resource, m_specs,
+                                                  m_resource);
+  }
+
+  void parse_args(int argc, char *argv[]) override {
+    ArgCursor cursor(std::span<char *const>(argv, argc));
+    parse_command_line(cursor);
+  }
+
+  void parse_args(std::span<const std::string_view> args) override {
+    ArgCursor cursor(args);
+    parse_command_line(cursor);
+  }
+
+  void parse_args(const ArgSeq &args) override {
+    m_arg_buffer.assign(args.begin(), args.end());
+    parse_args(m_arg_buffer);
+  }
+
+  void reset() override {
+    for (const auto &spec : m_specs.options().specs()) {
+      spec->reset();
+    }
+    for (const auto &spec : m_specs.args().specs()) {
+      spec->reset();
+    }
+    // Subparsers that have been built are kept for the next parse.
+    for (const auto &subparser : m_subparsers) {
+      if (subparser) {
+        subparser->reset();
       }
     }
-    validate_arg_specs();
+    m_subcommand.reset();
+    m_invoked_as.clear();
+    m_exit_code.reset();
+    m_response_files.clear();
   }
 
   [[nodiscard]] bool should_exit() const override {
@@ -145,55 +1199,264 @@ public:
   }
 
   void show_error(std::string_view message, int exit_code) override {
-    std::cerr << "Error: " << message << std::endl;
-    show_usage(std::cerr, exit_code);
+    m_specs.show_error(m_command_path, m_invoked_as, message);
+    m_exit_code = exit_code;
+  }
+
+  std::optional<int> parse_subcommand(size_t index,
+                                      std::string_view command_path,
+                                      std::string_view invoked_as,
+                                      ArgCursor &args) {
+    Impl &subparser = built_subparser(index);
+    m_subcommand = index;
+
+    subparser.m_command_path = command_path;
+    if (!command_path.empty()) {
+      subparser.m_command_path += " ";
+    }
+    subparser.m_command_path += invoked_as;
+    subparser.parse(args);
+    return subparser.m_exit_code;
   }
 
 private:
-  std::string m_description;
-  std::string m_invoked_as;
+  std::pmr::memory_resource *const m_resource;
+  SpecSet m_specs;
+  std::pmr::string m_invoked_as;
 
-  Flag::Ptr m_help_flag;
+  // The invocation of the parent parser, if this parses a subcommand.
+  std::pmr::string m_command_path;
 
-  std::vector<IOption::Ptr> m_opt_specs;
-  std::vector<IArgument::Ptr> m_arg_specs;
+  // The parser of each subcommand, once it has been built.
+  std::pmr::vector<std::shared_ptr<Impl>> m_subparsers;
+  std::optional<size_t> m_subcommand;
 
   std::optional<int> m_exit_code;
 
-  void show_help() {
-    std::cout << m_description << std::endl;
-    show_usage(std::cout, 0);
+  // Contiguous copy of the arguments passed to parse_args(const ArgSeq &).
+  std::pmr::vector<std::string_view> m_arg_buffer;
+
+  // Arguments read from response files, which parsed values may view.
+  Internal::ResponseFiles m_response_files;
+
+  // The environment, read when first needed.  Parsed values may view it.
+  std::optional<Internal::EnvIndex> m_env;
+
+  // The parser of a subcommand, built when first needed.
+  Impl &built_subparser(size_t index) {
+    auto &subparser = m_subparsers[index];
+    if (!subparser) {
+      const auto &command = m_specs.subcommands()[index];
+      auto built = Internal::make_shared_in<Impl>(m_resource, command.m_summary,
+                                                  m_resource);
+      built->set_output(m_specs.output());
+      if (m_specs.config()) {
+        built->use_config(m_specs.config(), config_section(index));
+      }
+      command.m_factory(built);
+      subparser = std::move(built);
+    }
+    return *subparser;
   }
 
-  void show_usage(std::ostream &outs, int exit_code) {
-    outs << "Usage: " << m_invoked_as;
-    for (auto spec : m_opt_specs) {
-      outs << " " << spec->usage();
+  // Parse a command line given to parse_args, unless it is a request from a
+  // shell completion script: "<program> --__complete CWORD WORD...".
+  void parse_command_line(ArgCursor &mut_args) {
+    ArgCursor request = mut_args;
+    if (request.size() >= 2) {
+      request.pop_front();
+      if (request.front() == "--__complete") {
+        request.pop_front();
+        complete(request);
+        return;
+      }
+    }
+    parse(mut_args);
+  }
+
+  // Write the candidates for word CWORD of WORD..., one per line.
+  void complete(ArgCursor &request) {
+    size_t cword = 0;
+    bool valid = !request.empty();
+    if (valid) {
+      const std::string_view cword_str = request.front();
+      const char *end = cword_str.data() + cword_str.size();
+      const auto [ptr, ec] = std::from_chars(cword_str.data(), end, cword);
+      valid = (ec == std::errc()) && (ptr == end);
+      request.pop_front();
+    }
+    std::vector<std::string_view> words;
+    for (; !request.empty(); request.pop_front()) {
+      words.push_back(request.front());
     }
-    for (auto spec : m_arg_specs) {
-      outs << " " << spec->usage();
+    m_invoked_as = words.empty() ? std::string_view() : words.front();
+    if (!valid || (cword == 0) || (cword > words.size())) {
+      show_error("Invalid completion request.", 1);
+      return;
     }
-    outs << std::endl;
 
-    if (!m_opt_specs.empty()) {
-      outs << "Options:" << std::endl;
-      for (auto spec : m_opt_specs) {
-        outs << spec->help() << std::endl;
+    std::vector<std::string> candidates;
+    const std::string program =
+        std::filesystem::path(words.front()).filename().string();
+    complete_words(words, cword, program, candidates);
+    std::string text;
+    for (const auto &candidate : candidates) {
+      text.append(candidate).append("\n");
+    }
+    m_specs.output()->write(OutputSink::Stream::out, text);
+    m_exit_code = 0;
+  }
+
+  // Find the candidates for words[cword], where words[0] invokes this
+  // parser.  key_prefix identifies this parser in completion cache keys.
+  void complete_words(std::span<const std::string_view> words, size_t cword,
+                      const std::string &key_prefix,
+                      std::vector<std::string> &candidates) {
+    // An option whose value is the next word.
+    std::optional<size_t> pending;
+    for (size_t i = 1; i < cword; ++i) {
+      const std::string_view word = words[i];
+      if (pending) {
+        pending.reset();
+        continue;
+      }
+      if (const auto match = m_specs.match_option(word);
+          match.m_kind == SpecSet::OptionMatch::Kind::found) {
+        if (m_specs.options().takes_value(match.m_index) && !match.m_value) {
+          pending = match.m_index;
+        }
+        continue;
+      }
+      if (m_specs.has_subcommands() && !word.starts_with("-")) {
+        if (const auto command = m_specs.find_subcommand(word)) {
+          built_subparser(*command).complete_words(
+              words.subspan(i), cword - i, key_prefix + " " + std::string(word),
+              candidates);
+        }
+        return;
       }
     }
 
-    if (!m_arg_specs.empty()) {
-      outs << "Arguments:" << std::endl;
-      for (auto spec : m_arg_specs) {
-        outs << spec->help() << std::endl;
+    const std::string_view word =
+        (cword < words.size()) ? words[cword] : std::string_view();
+    if (pending) {
+      complete_value(*pending, word, {}, key_prefix, candidates);
+      return;
+    }
+    const size_t eq_pos = word.find('=');
+    if (word.starts_with("--") && (eq_pos != std::string_view::npos)) {
+      const auto match = m_specs.match_option(word);
+      if (match.m_kind == SpecSet::OptionMatch::Kind::found) {
+        complete_value(match.m_index, word.substr(eq_pos + 1),
+                       word.substr(0, eq_pos + 1), key_prefix, candidates);
+      }
+      return;
+    }
+    if (word.starts_with("-")) {
+      const Internal::OptionTable &options = m_specs.options();
+      for (size_t i = 0; i < options.size(); ++i) {
+        for (const auto name : {options.short_name(i), options.long_name(i)}) {
+          if (!name.empty() && name.starts_with(word)) {
+            candidates.emplace_back(name);
+          }
+        }
       }
+      std::sort(candidates.begin(), candidates.end());
+      return;
     }
+    for (const auto &command : m_specs.subcommands()) {
+      if (command.m_name.starts_with(word)) {
+        candidates.emplace_back(command.m_name);
+      }
+    }
+  }
 
-    m_exit_code = exit_code;
+  // Add the values of an option that start with prefix, each preceded by
+  // lead, e.g., "--mode=".
+  void complete_value(size_t index, std::string_view prefix,
+                      std::string_view lead, const std::string &key_prefix,
+                      std::vector<std::string> &candidates) const {
+    const Internal::OptionTable &options = m_specs.options();
+    std::vector<std::string> values;
+    if (options.kind(index) == Internal::OptionKind::choice) {
+      values = options.specs()[index]->value_candidates();
+    }
+    if (const auto *completion = m_specs.completion(index)) {
+      const std::string key =
+          key_prefix + " " +
+          std::string(options.long_name(index).empty()
+                          ? options.short_name(index)
+                          : options.long_name(index));
+      auto listed = completer_values(*completion, key);
+      values.insert(values.end(), std::make_move_iterator(listed.begin()),
+                    std::make_move_iterator(listed.end()));
+    }
+    for (const auto &value : values) {
+      if (value.starts_with(prefix)) {
+        candidates.push_back(std::string(lead) + value);
+      }
+    }
+  }
+
+  static std::vector<std::string>
+  completer_values(const SpecSet::Completion &completion,
+                   const std::string &key) {
+    if (completion.m_max_age.count() <= 0) {
+      return completion.m_completer();
+    }
+    const auto cache = Internal::CompletionCache::standard();
+    if (auto cached = cache.load(key, completion.m_max_age)) {
+      return std::move(*cached);
+    }
+    auto values = completion.m_completer();
+    cache.store(key, values);
+    return values;
+  }
+
+  // Take option values from section of config, and those of subcommands
+  // from nested sections.
+  void use_config(std::shared_ptr<const Internal::ConfigFile> config,
+                  std::string_view section) {
+    m_specs.set_config(std::move(config), section);
+    for (size_t i = 0; i < m_subparsers.size(); ++i) {
+      if (m_subparsers[i]) {
+        m_subparsers[i]->use_config(m_specs.config(), config_section(i));
+      }
+    }
+  }
+
+  // The config section of a subcommand, e.g., "remote.add" for "git remote
+  // add".
+  [[nodiscard]] std::string config_section(size_t index) const {
+    std::string section(m_specs.config_section());
+    if (!section.empty()) {
+      section.append(".");
+    }
+    section.append(m_specs.subcommands()[index].m_name);
+    return section;
+  }
+
+  void parse(ArgCursor &mut_args) {
+    if (!m_env && m_specs.uses_env()) {
+      m_env.emplace(m_resource);
+    }
+    const SpecTarget target{*this, m_specs};
+    ParseRun<SpecTarget> run(m_specs, target, m_exit_code,
+                             m_env ? &*m_env : nullptr, m_command_path);
+    run.parse(mut_args, m_response_files);
+    m_invoked_as = run.invoked_as();
   }
 };
 
-ArgumentParser::Ptr ArgumentParser::create(std::string_view description) {
-  return std::make_shared<Impl>(description);
+std::optional<int> SpecTarget::parse_subcommand(size_t index,
+                                                std::string_view command_path,
+                                                std::string_view invoked_as,
+                                                ArgCursor &args) const {
+  return m_parser.parse_subcommand(index, command_path, invoked_as, args);
+}
+
+ArgumentParser::Ptr ArgumentParser::create(std::string_view description,
+                                           std::pmr::memory_resource *resource) {
+  return Internal::make_shared_in<Impl>(resource, description, resource);
 }
-} // namespace ArgParse
\ No newline at end of file
+} // namespace ArgParse
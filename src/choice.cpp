@@ -1,69 +1,114 @@
 #include "choice.hpp"
+#include "allocation.hpp"
 #include <algorithm>
 #include <cctype>
-#include <sstream>
 #include <stdexcept>
 
 namespace {
-auto lowercase(std::string_view sval) {
-  std::string result(sval);
-  std::transform(result.begin(), result.end(), result.begin(),
-                 [](unsigned char c) { return std::tolower(c); });
-  return result;
+char fold(char c) {
+  return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+// Compare a folded name with a value, folding the value as it goes.
+int compare_folded(std::string_view folded, std::string_view value) {
+  const size_t size = std::min(folded.size(), value.size());
+  for (size_t i = 0; i < size; ++i) {
+    const char c = fold(value[i]);
+    if (folded[i] != c) {
+      return (static_cast<unsigned char>(folded[i]) <
+              static_cast<unsigned char>(c))
+                 ? -1
+                 : 1;
+    }
+  }
+  if (folded.size() == value.size()) {
+    return 0;
+  }
+  return (folded.size() < value.size()) ? -1 : 1;
 }
 } // namespace
 
 namespace ArgParse {
+namespace Internal {
+ChoiceTable::ChoiceTable(const std::vector<std::string_view> &names,
+                         std::pmr::memory_resource *resource)
+    : m_names(names.begin(), names.end(), resource), m_folded(resource),
+      m_sorted(resource) {
+  size_t total_size = 0;
+  for (const auto name : names) {
+    total_size += name.size();
+  }
+  m_folded.reserve(total_size);
+  m_sorted.reserve(names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    m_sorted.push_back({static_cast<uint32_t>(m_folded.size()),
+                        static_cast<uint32_t>(names[i].size()), i});
+    std::transform(names[i].begin(), names[i].end(),
+                   std::back_inserter(m_folded), fold);
+  }
+  std::sort(m_sorted.begin(), m_sorted.end(),
+            [this](const Entry &lhs, const Entry &rhs) {
+              const int order = folded(lhs).compare(folded(rhs));
+              return (order != 0) ? (order < 0) : (lhs.index < rhs.index);
+            });
+}
+
+std::optional<size_t> ChoiceTable::find(std::string_view value) const {
+  const auto found = std::lower_bound(
+      m_sorted.begin(), m_sorted.end(), value,
+      [this](const Entry &entry, std::string_view target) {
+        return compare_folded(folded(entry), target) < 0;
+      });
+  if ((found == m_sorted.end()) ||
+      (compare_folded(folded(*found), value) != 0)) {
+    return std::nullopt;
+  }
+  return found->index;
+}
+} // namespace Internal
+
 struct ChoiceImpl : public Choice {
   ChoiceImpl(std::string_view short_name, std::string_view long_name,
              std::string_view help_msg,
-             const std::vector<std::string> &valid_choices,
-             std::string_view default_choice)
-      : Choice(short_name, long_name, help_msg, default_choice),
-        m_valid_choices(valid_choices) {
-
-    if (valid_choices.empty()) {
-      throw std::invalid_argument("At least one choice must be specified.");
-    }
-  }
+             const std::vector<std::string_view> &valid_choices,
+             std::string_view default_choice,
+             std::pmr::memory_resource *resource)
+      : Choice(short_name, long_name, help_msg, default_choice, resource),
+        m_table(valid_choices, resource) {}
 
   [[nodiscard]] std::string help() const override {
-    std::ostringstream outs;
-    outs << "  Valid values (case-insensitive): (";
-    std::string sep = "";
-    for (const auto choice : m_valid_choices) {
-      outs << sep << "'" << choice << "'";
-      sep = ", ";
-    }
-    outs << ")";
+    return Internal::option_help_block(
+        m_short, m_long,
+        Internal::env_help_msg(
+            Internal::choice_help_msg(m_help_msg, m_table.names()),
+            m_env_var));
+  }
 
-    return Internal::option_help_block(m_short, m_long,
-                                       m_help_msg + outs.str());
+  [[nodiscard]] std::vector<std::string> value_candidates() const override {
+    return {m_table.names().begin(), m_table.names().end()};
   }
 
 protected:
   [[nodiscard]] bool valid_value(const std::string &v) const override {
-    const std::string v_lcase = lowercase(v);
-    for (const auto &curr_choice : m_valid_choices) {
-      const std::string curr_lcase = lowercase(curr_choice);
-      if (curr_lcase == v_lcase) {
-        return true;
-      }
-    }
-    return false;
+    return m_table.find(v).has_value();
   }
 
 private:
-  std::vector<std::string> m_valid_choices;
+  const Internal::ChoiceTable m_table;
 };
 
 Choice::Ptr Choice::create(std::string_view short_name,
                            std::string_view long_name,
                            std::string_view help_msg,
-                           const std::vector<std::string> &valid_choices) {
-  const auto default_choice =
-      valid_choices.empty() ? "" : valid_choices.front();
-  return Choice::Ptr(new ChoiceImpl(short_name, long_name, help_msg,
-                                    valid_choices, default_choice));
+                           const std::vector<std::string> &valid_choices,
+                           std::pmr::memory_resource *resource) {
+  if (valid_choices.empty()) {
+    throw std::invalid_argument("At least one choice must be specified.");
+  }
+  const std::vector<std::string_view> names(valid_choices.begin(),
+                                            valid_choices.end());
+  return Internal::make_shared_in<ChoiceImpl>(resource, short_name, long_name,
+                                              help_msg, names,
+                                              valid_choices.front(), resource);
 };
-} // namespace ArgParse
\ No newline at end of file
+} // namespace ArgParse
@@ -0,0 +1,222 @@
+#include "command_line.hpp"
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace ArgParse {
+
+namespace {
+bool is_space(char c) { return (c == ' ') || (c == '\t') || (c == '\n'); }
+
+// Find the first of the characters Cs at or after pos, or return size.
+// Most of a command line is ordinary text, so scan it a vector at a time
+// where the target supports it.
+template <char... Cs>
+size_t find_any(const char *data, size_t size, size_t pos) {
+#if defined(__AVX2__)
+  for (; pos + 32 <= size; pos += 32) {
+    const __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+    __m256i hits = _mm256_setzero_si256();
+    ((hits = _mm256_or_si256(hits,
+                             _mm256_cmpeq_epi8(block, _mm256_set1_epi8(Cs)))),
+     ...);
+    const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+    if (mask != 0) {
+      return pos + std::countr_zero(mask);
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  for (; pos + 16 <= size; pos += 16) {
+    const __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+    __m128i hits = _mm_setzero_si128();
+    ((hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, _mm_set1_epi8(Cs)))),
+     ...);
+    const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+    if (mask != 0) {
+      return pos + std::countr_zero(mask);
+    }
+  }
+#endif
+  for (; pos < size; ++pos) {
+    const char c = data[pos];
+    if (((c == Cs) || ...)) {
+      return pos;
+    }
+  }
+  return size;
+}
+
+// Characters that end a run of ordinary, unquoted text.
+size_t find_unquoted_special(std::string_view line, size_t pos) {
+  return find_any<' ', '\t', '\n', '\'', '"', '\\'>(line.data(), line.size(),
+                                                    pos);
+}
+
+size_t find_single_quote(std::string_view line, size_t pos) {
+  return find_any<'\''>(line.data(), line.size(), pos);
+}
+
+size_t find_double_quote_special(std::string_view line, size_t pos) {
+  return find_any<'"', '\\'>(line.data(), line.size(), pos);
+}
+
+bool escapable_in_double_quotes(char c) {
+  return (c == '$') || (c == '`') || (c == '"') || (c == '\\') || (c == '\n');
+}
+
+[[noreturn]] void unterminated(char quote) {
+  throw std::invalid_argument(std::string("Unterminated ") + quote +
+                              " in command line.");
+}
+
+// Unescapes one argument into a buffer.
+class Unescaper {
+public:
+  Unescaper(std::string_view line, char *dest) : m_line(line), m_dest(dest) {}
+
+  // Unescape the argument that starts at pos.  The unescaped text starts at
+  // dest.  Returns the position just past the argument.
+  size_t unescape(size_t pos) {
+    const size_t size = m_line.size();
+    while ((pos < size) && !is_space(m_line[pos])) {
+      const char c = m_line[pos];
+      if (c == '\\') {
+        pos = unescape_backslash(pos);
+      } else if (c == '\'') {
+        const size_t close = find_single_quote(m_line, pos + 1);
+        if (close == size) {
+          unterminated(c);
+        }
+        append(pos + 1, close);
+        pos = close + 1;
+      } else if (c == '"') {
+        pos = unescape_double_quoted(pos + 1);
+      } else {
+        const size_t next = find_unquoted_special(m_line, pos);
+        append(pos, next);
+        pos = next;
+      }
+    }
+    return pos;
+  }
+
+  [[nodiscard]] size_t length() const { return m_length; }
+
+private:
+  std::string_view m_line;
+  char *const m_dest;
+  size_t m_length{0};
+
+  void append(size_t begin, size_t end) {
+    m_line.copy(m_dest + m_length, end - begin, begin);
+    m_length += end - begin;
+  }
+
+  void append(char c) { m_dest[m_length++] = c; }
+
+  size_t unescape_backslash(size_t pos) {
+    if (pos + 1 == m_line.size()) {
+      // A trailing backslash escapes nothing.
+      append('\\');
+      return pos + 1;
+    }
+    if (m_line[pos + 1] != '\n') {
+      append(m_line[pos + 1]);
+    }
+    return pos + 2;
+  }
+
+  // Returns the position just past the closing quote.
+  size_t unescape_double_quoted(size_t pos) {
+    const size_t size = m_line.size();
+    while (true) {
+      const size_t next = find_double_quote_special(m_line, pos);
+      if (next == size) {
+        unterminated('"');
+      }
+      append(pos, next);
+      if (m_line[next] == '"') {
+        return next + 1;
+      }
+      // A backslash.
+      if ((next + 1 < size) && escapable_in_double_quotes(m_line[next + 1])) {
+        if (m_line[next + 1] != '\n') {
+          append(m_line[next + 1]);
+        }
+        pos = next + 2;
+      } else {
+        append('\\');
+        pos = next + 1;
+      }
+    }
+  }
+};
+} // namespace
+
+void CommandLine::assign(std::string_view line) {
+  m_args.clear();
+  size_t used = 0;
+
+  const size_t size = line.size();
+  size_t pos = 0;
+  while (true) {
+    // Skip separators, including line continuations.
+    while (pos < size) {
+      if (is_space(line[pos])) {
+        ++pos;
+      } else if ((line[pos] == '\\') && (pos + 1 < size) &&
+                 (line[pos + 1] == '\n')) {
+        pos += 2;
+      } else {
+        break;
+      }
+    }
+    if (pos == size) {
+      break;
+    }
+
+    // Most arguments are plain words, or are quoted as a whole and hold no
+    // escapes.  Those can view the line.
+    const size_t start = pos;
+    const size_t end = find_unquoted_special(line, start);
+    if ((end == size) || is_space(line[end])) {
+      m_args.push_back(line.substr(start, end - start));
+      pos = end;
+      continue;
+    }
+    const char quote = line[start];
+    if ((end == start) && ((quote == '\'') || (quote == '"'))) {
+      const size_t close = (quote == '\'')
+                               ? find_single_quote(line, start + 1)
+                               : find_double_quote_special(line, start + 1);
+      if ((close < size) && (line[close] == quote) &&
+          ((close + 1 == size) || is_space(line[close + 1]))) {
+        m_args.push_back(line.substr(start + 1, close - start - 1));
+        pos = close + 1;
+        continue;
+      }
+    }
+
+    // Unescaping never lengthens text, so one buffer the size of the line
+    // holds every unescaped argument.  Nothing has been unescaped into the
+    // old buffer yet if it is too small.
+    if (m_capacity < size) {
+      m_unescaped = std::make_unique<char[]>(size);
+      m_capacity = size;
+    }
+
+    Unescaper unescaper(line, m_unescaped.get() + used);
+    pos = unescaper.unescape(start);
+    m_args.emplace_back(m_unescaped.get() + used, unescaper.length());
+    used += unescaper.length();
+  }
+}
+} // namespace ArgParse
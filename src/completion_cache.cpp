@@ -0,0 +1,152 @@
+#include "completion_cache.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <system_error>
+
+#if defined(__APPLE__)
+#include <mach-o/dyld.h>
+#endif
+
+namespace ArgParse::Internal {
+
+namespace {
+// The first line of every entry.  Change it when the format changes.
+constexpr std::string_view format_tag = "arg_parse completion cache 1";
+
+std::filesystem::path executable_path() {
+  std::error_code ec;
+#if defined(__APPLE__)
+  uint32_t size = 0;
+  _NSGetExecutablePath(nullptr, &size);
+  std::string path(size, '\0');
+  if (_NSGetExecutablePath(path.data(), &size) != 0) {
+    return {};
+  }
+  path.resize(path.find('\0'));
+  return std::filesystem::canonical(path, ec);
+#elif defined(__linux__)
+  return std::filesystem::read_symlink("/proc/self/exe", ec);
+#else
+  return {};
+#endif
+}
+
+// Identify the build of the running program by the path, size and
+// modification time of its executable.
+std::string executable_fingerprint() {
+  const auto path = executable_path();
+  if (path.empty()) {
+    return {};
+  }
+  std::error_code ec;
+  const auto size = std::filesystem::file_size(path, ec);
+  const auto mtime = std::filesystem::last_write_time(path, ec);
+  if (ec) {
+    return {};
+  }
+  std::ostringstream outs;
+  outs << path.string() << " " << size << " "
+       << mtime.time_since_epoch().count();
+  return outs.str();
+}
+
+std::filesystem::path cache_directory() {
+  if (const char *xdg_home = std::getenv("XDG_CACHE_HOME");
+      (xdg_home != nullptr) && (*xdg_home != '\0')) {
+    return std::filesystem::path(xdg_home) / "arg_parse";
+  }
+  if (const char *home = std::getenv("HOME");
+      (home != nullptr) && (*home != '\0')) {
+    return std::filesystem::path(home) / ".cache" / "arg_parse";
+  }
+  return {};
+}
+} // namespace
+
+CompletionCache::CompletionCache(std::filesystem::path directory,
+                                 std::string fingerprint)
+    : m_directory(std::move(directory)), m_fingerprint(std::move(fingerprint)) {
+}
+
+CompletionCache CompletionCache::standard() {
+  return {cache_directory(), executable_fingerprint()};
+}
+
+std::optional<std::vector<std::string>>
+CompletionCache::load(std::string_view key,
+                      std::chrono::seconds max_age) const {
+  if (m_directory.empty()) {
+    return std::nullopt;
+  }
+  const auto path = entry_path(key);
+  std::error_code ec;
+  const auto mtime = std::filesystem::last_write_time(path, ec);
+  if (ec || (std::filesystem::file_time_type::clock::now() - mtime > max_age)) {
+    return std::nullopt;
+  }
+
+  std::ifstream ins(path);
+  std::string tag;
+  std::string fingerprint;
+  std::string stored_key;
+  if (!std::getline(ins, tag) || (tag != format_tag) ||
+      !std::getline(ins, fingerprint) || (fingerprint != m_fingerprint) ||
+      !std::getline(ins, stored_key) || (stored_key != key)) {
+    return std::nullopt;
+  }
+  std::vector<std::string> result;
+  for (std::string line; std::getline(ins, line);) {
+    result.push_back(std::move(line));
+  }
+  return result;
+}
+
+void CompletionCache::store(std::string_view key,
+                            const std::vector<std::string> &candidates) const {
+  if (m_directory.empty() || (key.find('\n') != std::string_view::npos)) {
+    return;
+  }
+  std::error_code ec;
+  std::filesystem::create_directories(m_directory, ec);
+  if (ec) {
+    return;
+  }
+
+  // Write a private file, then rename it into place, so that a concurrent
+  // reader sees either the old entry or the new one.
+  const auto path = entry_path(key);
+  auto temp_path = path;
+  temp_path += "." + std::to_string(std::random_device()()) + ".tmp";
+  {
+    std::ofstream outs(temp_path);
+    outs << format_tag << "\n" << m_fingerprint << "\n" << key << "\n";
+    for (const auto &candidate : candidates) {
+      if (candidate.find('\n') == std::string::npos) {
+        outs << candidate << "\n";
+      }
+    }
+    if (!outs.flush()) {
+      outs.close();
+      std::filesystem::remove(temp_path, ec);
+      return;
+    }
+  }
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec) {
+    std::filesystem::remove(temp_path, ec);
+  }
+}
+
+std::filesystem::path
+CompletionCache::entry_path(std::string_view key) const {
+  // Keys may hold any characters, so entries are named by hash.  A collision
+  // is detected by the key stored in the entry.
+  std::ostringstream name;
+  name << std::hex << std::hash<std::string_view>()(key) << ".txt";
+  return m_directory / name.str();
+}
+} // namespace ArgParse::Internal
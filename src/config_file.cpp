@@ -0,0 +1,164 @@
+#include "config_file.hpp"
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <system_error>
+
+namespace ArgParse::Internal {
+
+namespace {
+bool is_blank(char c) {
+  return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\f') ||
+         (c == '\v');
+}
+
+std::string_view trim(std::string_view text) {
+  while (!text.empty() && is_blank(text.front())) {
+    text.remove_prefix(1);
+  }
+  while (!text.empty() && is_blank(text.back())) {
+    text.remove_suffix(1);
+  }
+  return text;
+}
+
+// Remove a comment that follows a value: '#' preceded by whitespace.
+std::string_view strip_comment(std::string_view value) {
+  for (size_t pos = value.find('#'); pos != std::string_view::npos;
+       pos = value.find('#', pos + 1)) {
+    if ((pos > 0) && is_blank(value[pos - 1])) {
+      return trim(value.substr(0, pos));
+    }
+  }
+  return value;
+}
+
+std::string line_error(std::string_view problem, size_t line_num,
+                       std::string_view name) {
+  return std::string(problem) + " on line " + std::to_string(line_num) +
+         " of config file '" + std::string(name) + "'.";
+}
+} // namespace
+
+OptErrMsg ConfigFile::load(std::string_view path) {
+  m_entries.clear();
+  m_slots.clear();
+  m_file.reset();
+  const std::string path_str(path);
+  try {
+    m_file.emplace(path_str);
+  } catch (const std::system_error &e) {
+    return "Cannot read config file '" + path_str +
+           "': " + e.code().message() + ".";
+  }
+  return parse(m_file->contents(), path);
+}
+
+OptErrMsg ConfigFile::parse(std::string_view contents, std::string_view name) {
+  // Every entry takes at least one line, so one allocation of each table
+  // suffices.  Keeping the slots at most half full keeps probes short.
+  const size_t max_entries =
+      std::count(contents.begin(), contents.end(), '\n') + 1;
+  m_entries.clear();
+  m_entries.reserve(max_entries);
+  m_slots.assign(std::bit_ceil(2 * max_entries), 0);
+
+  std::string_view section;
+  size_t section_hash = hash_section(section);
+  size_t line_num = 0;
+  while (!contents.empty()) {
+    const size_t eol = contents.find('\n');
+    const std::string_view line = trim(contents.substr(0, eol));
+    contents.remove_prefix((eol == std::string_view::npos) ? contents.size()
+                                                           : eol + 1);
+    ++line_num;
+
+    if (line.empty() || (line.front() == '#') || (line.front() == ';')) {
+      continue;
+    }
+
+    if (line.front() == '[') {
+      const size_t close = line.find(']');
+      if (close == std::string_view::npos) {
+        return line_error("Unterminated section header", line_num, name);
+      }
+      section = trim(line.substr(1, close - 1));
+      section_hash = hash_section(section);
+      continue;
+    }
+
+    const size_t eq_pos = line.find('=');
+    if (eq_pos == std::string_view::npos) {
+      return line_error("Expected 'key = value'", line_num, name);
+    }
+    const std::string_view key = trim(line.substr(0, eq_pos));
+    if (key.empty()) {
+      return line_error("Missing key", line_num, name);
+    }
+
+    std::string_view value = trim(line.substr(eq_pos + 1));
+    const char quote = value.empty() ? '\0' : value.front();
+    if ((quote == '"') || (quote == '\'')) {
+      const size_t close = value.find(quote, 1);
+      if (close == std::string_view::npos) {
+        return line_error("Unterminated quote", line_num, name);
+      }
+      const std::string_view rest = trim(value.substr(close + 1));
+      if (!rest.empty() && (rest.front() != '#')) {
+        return line_error("Unexpected text after quoted value", line_num,
+                          name);
+      }
+      value = value.substr(1, close - 1);
+    } else {
+      value = strip_comment(value);
+    }
+    insert({section, key, value}, section_hash);
+  }
+
+  return {};
+}
+
+std::optional<std::string_view> ConfigFile::find(std::string_view section,
+                                                 std::string_view key) const {
+  if (m_slots.empty()) {
+    return std::nullopt;
+  }
+  const uint32_t slot = m_slots[find_slot(section, key, hash_section(section))];
+  if (slot == 0) {
+    return std::nullopt;
+  }
+  return m_entries[slot - 1].value;
+}
+
+size_t ConfigFile::hash_section(std::string_view section) {
+  // Distinguishes a key in one section from the same key in another.
+  return std::hash<std::string_view>()(section) * 0x9e3779b97f4a7c15ULL;
+}
+
+size_t ConfigFile::find_slot(std::string_view section, std::string_view key,
+                             size_t section_hash) const {
+  const size_t mask = m_slots.size() - 1;
+  size_t pos = (std::hash<std::string_view>()(key) ^ section_hash) & mask;
+  // Linear probing.  The table is never full, so an empty slot ends the
+  // search.
+  while (m_slots[pos] != 0) {
+    const Entry &entry = m_entries[m_slots[pos] - 1];
+    if ((entry.key == key) && (entry.section == section)) {
+      break;
+    }
+    pos = (pos + 1) & mask;
+  }
+  return pos;
+}
+
+void ConfigFile::insert(const Entry &entry, size_t section_hash) {
+  uint32_t &slot = m_slots[find_slot(entry.section, entry.key, section_hash)];
+  if (slot != 0) {
+    // A later occurrence of a key overrides an earlier one.
+    m_entries[slot - 1].value = entry.value;
+    return;
+  }
+  m_entries.push_back(entry);
+  slot = static_cast<uint32_t>(m_entries.size());
+}
+} // namespace ArgParse::Internal
@@ -0,0 +1,82 @@
+#include "edit_distance.hpp"
+#include <algorithm>
+
+namespace ArgParse::Internal {
+
+EditDistance::EditDistance(std::string_view pattern) : m_size(pattern.size()) {
+  for (size_t i = 0; i < m_size; ++i) {
+    m_positions[static_cast<unsigned char>(pattern[i])] |= uint64_t{1} << i;
+  }
+}
+
+std::optional<size_t> EditDistance::to(std::string_view text,
+                                       size_t max_distance) const {
+  if (m_size == 0) {
+    return (text.size() <= max_distance) ? std::optional(text.size())
+                                         : std::nullopt;
+  }
+
+  // Bit i of vp (vn) is set if the distance increases (decreases) from row i
+  // to row i + 1 of the current column.  The score is the last row's.
+  const uint64_t last = uint64_t{1} << (m_size - 1);
+  uint64_t vp = ~uint64_t{0};
+  uint64_t vn = 0;
+  size_t score = m_size;
+  for (size_t j = 0; j < text.size(); ++j) {
+    const uint64_t eq = m_positions[static_cast<unsigned char>(text[j])];
+    const uint64_t xv = eq | vn;
+    const uint64_t xh = (((eq & vp) + vp) ^ vp) | eq;
+    uint64_t hp = vn | ~(xh | vp);
+    uint64_t hn = vp & xh;
+    if ((hp & last) != 0) {
+      ++score;
+    } else if ((hn & last) != 0) {
+      --score;
+    }
+    // Each remaining character can lower the score by at most one.
+    if (score > max_distance + (text.size() - j - 1)) {
+      return std::nullopt;
+    }
+    // Row 0 is the distance from the empty prefix, which grows by one
+    // with each column.
+    hp = (hp << 1) | 1;
+    hn <<= 1;
+    vp = hn | ~(xv | hp);
+    vn = hp & xv;
+  }
+  return (score <= max_distance) ? std::optional(score) : std::nullopt;
+}
+
+std::vector<std::string_view>
+nearest_names(std::string_view name,
+              std::span<const std::string_view> candidates,
+              size_t max_distance) {
+  std::vector<std::string_view> result;
+  if (name.size() > EditDistance::max_size) {
+    return result;
+  }
+  const EditDistance distance(name);
+  size_t best = max_distance;
+  for (const auto candidate : candidates) {
+    // The distance is at least the difference in length, so most candidates
+    // are dismissed without being compared.
+    const size_t length_diff = (candidate.size() > name.size())
+                                   ? candidate.size() - name.size()
+                                   : name.size() - candidate.size();
+    if (length_diff > best) {
+      continue;
+    }
+    const auto found = distance.to(candidate, best);
+    if (!found) {
+      continue;
+    }
+    if (*found < best) {
+      best = *found;
+      result.clear();
+    }
+    result.push_back(candidate);
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+} // namespace ArgParse::Internal
@@ -0,0 +1,65 @@
+#include "env_index.hpp"
+#include <cstring>
+
+#if defined(_WIN32)
+#include <stdlib.h>
+#elif defined(__APPLE__)
+#include <crt_externs.h>
+#else
+extern "C" char **environ;
+#endif
+
+namespace ArgParse::Internal {
+
+namespace {
+const char *const *process_environ() {
+#if defined(_WIN32)
+  return _environ;
+#elif defined(__APPLE__)
+  return *_NSGetEnviron();
+#else
+  return environ;
+#endif
+}
+} // namespace
+
+EnvIndex::EnvIndex(const char *const *envp,
+                   std::pmr::memory_resource *resource)
+    : m_text(resource), m_vars(resource) {
+  // Copy everything first, so that no view is invalidated by a later copy.
+  size_t num_vars = 0;
+  size_t total_size = 0;
+  for (auto *var = envp; *var != nullptr; ++var) {
+    total_size += std::strlen(*var);
+    ++num_vars;
+  }
+  m_text.reserve(total_size);
+  for (auto *var = envp; *var != nullptr; ++var) {
+    m_text.append(*var);
+  }
+
+  m_vars.reserve(num_vars);
+  std::string_view text(m_text);
+  for (auto *var = envp; *var != nullptr; ++var) {
+    const size_t size = std::strlen(*var);
+    const std::string_view entry = text.substr(0, size);
+    text.remove_prefix(size);
+
+    const auto eq_pos = entry.find('=');
+    if ((eq_pos != std::string_view::npos) && (eq_pos > 0)) {
+      m_vars.try_emplace(entry.substr(0, eq_pos), entry.substr(eq_pos + 1));
+    }
+  }
+}
+
+EnvIndex::EnvIndex(std::pmr::memory_resource *resource)
+    : EnvIndex(process_environ(), resource) {}
+
+std::optional<std::string_view> EnvIndex::find(std::string_view name) const {
+  const auto found = m_vars.find(name);
+  if (found == m_vars.end()) {
+    return std::nullopt;
+  }
+  return found->second;
+}
+} // namespace ArgParse::Internal
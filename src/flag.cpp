@@ -1,46 +1,136 @@
 #include "flag.hpp"
+#include "allocation.hpp"
 #include "help_fmt.hpp"
+#include "value_converter.hpp"
 
 namespace ArgParse {
 
 struct FlagImpl : public Flag {
   FlagImpl(std::string_view short_name, std::string_view long_name,
-           std::string_view help_msg)
-      : m_short(short_name), m_long(long_name), m_help_msg(help_msg) {}
+           std::string_view help_msg, std::pmr::memory_resource *resource)
+      : m_short(short_name, resource), m_long(long_name, resource),
+        m_help_msg(help_msg, resource), m_env_var(resource) {}
 
   [[nodiscard]] std::string usage() const override {
     return Internal::flag_usage_str(m_short, m_long);
   }
 
   [[nodiscard]] std::string help() const override {
-    return Internal::flag_help_block(m_short, m_long, m_help_msg);
+    return Internal::flag_help_block(
+        m_short, m_long, Internal::env_help_msg(m_help_msg, m_env_var));
   }
 
-  [[nodiscard]] bool is_set() const override { return m_is_set; }
+  [[nodiscard]] std::string_view short_name() const override {
+    return m_short;
+  }
+
+  [[nodiscard]] std::string_view long_name() const override { return m_long; }
+
+  [[nodiscard]] bool is_set() const override {
+    return m_bits ? m_bits->test(m_bit) : m_is_set;
+  }
+
+  size_t store_in(const Internal::FlagBits::Ptr &bits) override {
+    const bool was_set = is_set();
+    // A flag shared by several parsers keeps its state in the last one's
+    // block.  The others must then set it through parse_value.
+    if (m_bits) {
+      m_bits->release(m_bit);
+    }
+    m_bit = bits->add();
+    m_bits = bits;
+    m_bits->set(m_bit, was_set);
+    return m_bit;
+  }
+
+  [[nodiscard]] bool takes_value() const override { return false; }
+
+  [[nodiscard]] std::vector<std::string> value_candidates() const override {
+    return {};
+  }
+
+  void reset() override { set(false); }
+
+  [[nodiscard]] SpecState initial_state() const override { return false; }
+
+  void set_env_var(std::string_view name) override { m_env_var = name; }
+
+  [[nodiscard]] std::string_view env_var() const override { return m_env_var; }
 
-  ParseResult parse(ArgSeq &args) override {
-    if (!args.empty()) {
-      std::string_view next = args.front();
-      if ((next == m_short) || (next == m_long)) {
-        m_is_set = true;
-        args.pop_front();
-        return ParseResult::match();
-      }
+  ParseResult parse_value(std::string_view source,
+                          std::string_view value) final {
+    bool is_set = false;
+    const auto result = parse_value_into(source, value, is_set);
+    if (!result.has_error()) {
+      set(is_set);
     }
+    return result;
+  }
+
+  ParseResult parse_value(std::string_view source, std::string_view value,
+                          SpecState &state) const final {
+    return parse_value_into(source, value, std::any_cast<bool &>(state));
+  }
 
-    return ParseResult::no_match();
+  [[nodiscard]] Internal::OptionDispatch dispatch() override {
+    return {Internal::OptionKind::flag, this, &dispatch_parse_value,
+            &dispatch_parse_state};
   }
 
 private:
-  const std::string m_short;
-  const std::string m_long;
-  const std::string m_help_msg;
+  // parse_value is final, so these calls are not virtual.
+  static ParseResult dispatch_parse_value(void *self, std::string_view source,
+                                          std::string_view value) {
+    return static_cast<FlagImpl *>(self)->parse_value(source, value);
+  }
+
+  static ParseResult dispatch_parse_state(const void *self,
+                                          std::string_view source,
+                                          std::string_view value,
+                                          SpecState &state) {
+    return static_cast<const FlagImpl *>(self)->parse_value(source, value,
+                                                            state);
+  }
+
+  void set(bool value) {
+    if (m_bits) {
+      m_bits->set(m_bit, value);
+    } else {
+      m_is_set = value;
+    }
+  }
+
+  // A flag's value must be 0 or 1, like an explicit boolean, or true or
+  // false, as in config files.
+  static ParseResult parse_value_into(std::string_view source,
+                                      std::string_view value, bool &is_set) {
+    if ((value == "true") || (value == "false")) {
+      is_set = (value == "true");
+      return ParseResult::match();
+    }
+    Internal::ValueConverter<bool> converter(source, value);
+    if (!converter.failed()) {
+      is_set = converter.m_value;
+    }
+    return converter.as_parse_result();
+  }
+
+  const std::pmr::string m_short;
+  const std::pmr::string m_long;
+  const std::pmr::string m_help_msg;
+  std::pmr::string m_env_var;
+  // The state is kept in m_bits once the flag is added to a parser, and in
+  // m_is_set until then.
+  Internal::FlagBits::Ptr m_bits;
+  size_t m_bit{0};
   bool m_is_set{false};
 };
 
 Flag::Ptr Flag::create(std::string_view short_name, std::string_view long_name,
-                       std::string_view help_msg) {
-  return std::make_shared<FlagImpl>(short_name, long_name, help_msg);
+                       std::string_view help_msg,
+                       std::pmr::memory_resource *resource) {
+  return Internal::make_shared_in<FlagImpl>(resource, short_name, long_name,
+                                            help_msg, resource);
 }
 
 } // namespace ArgParse
@@ -1,7 +1,6 @@
 #include "help_fmt.hpp"
 #include <algorithm>
 #include <cctype>
-#include <sstream>
 
 namespace ArgParse::Internal {
 
@@ -15,12 +14,12 @@ string to_upper(string_view s) {
 }
 
 string value_name(string_view option_name) {
-  string result = option_name.data();
-  const auto after_dash = result.find_first_not_of("-");
-  if (after_dash != string::npos) {
-    result = result.substr(after_dash);
+  // option_name need not be null-terminated.
+  const auto after_dash = option_name.find_first_not_of('-');
+  if (after_dash != string_view::npos) {
+    option_name.remove_prefix(after_dash);
   }
-  return to_upper(result);
+  return to_upper(option_name);
 }
 
 string usage_str(string_view short_name, string_view long_name) {
@@ -30,7 +29,12 @@ string usage_str(string_view short_name, string_view long_name) {
   return string(short_name) + "|" + string(long_name);
 }
 
-string bracketed(string_view s) { return string("[") + s.data() + "]"; }
+string bracketed(string_view s) {
+  string result;
+  result.reserve(s.size() + 2);
+  result.append("[").append(s).append("]");
+  return result;
+}
 
 string flag_help_title(string_view short_name, string_view long_name) {
   return usage_str(short_name, long_name);
@@ -63,9 +67,14 @@ string arg_usage_str(string_view arg_name, Nargs nargs) {
 }
 
 string help_block(string_view usage_label, string_view help_msg) {
-  ostringstream outs;
-  outs << "    " << usage_label << endl << "        " << help_msg;
-  return outs.str();
+  const string_view label_indent = "    ";
+  const string_view help_indent = "        ";
+  string result;
+  result.reserve(label_indent.size() + usage_label.size() + 1 +
+                 help_indent.size() + help_msg.size());
+  result.append(label_indent).append(usage_label).append("\n");
+  result.append(help_indent).append(help_msg);
+  return result;
 }
 
 string flag_help_block(string_view short_name, string_view long_name,
@@ -82,4 +91,80 @@ string arg_help_block(string_view arg_name, Nargs nargs, string_view help_msg) {
   return help_block(arg_usage_str(arg_name, nargs), help_msg);
 }
 
+string choice_help_msg(string_view help_msg,
+                       span<const pmr::string> choices) {
+  string result(help_msg);
+  result.append("  Valid values (case-insensitive): (");
+  string_view sep;
+  for (const auto &choice : choices) {
+    result.append(sep).append("'").append(choice).append("'");
+    sep = ", ";
+  }
+  result.append(")");
+  return result;
+}
+
+string env_help_msg(string_view help_msg, string_view env_var) {
+  string result(help_msg);
+  if (!env_var.empty()) {
+    result.append("  [env: ").append(env_var).append("]");
+  }
+  return result;
+}
+
+string command_usage_str() { return "COMMAND [ARGS ...]"; }
+
+string command_help_block(string_view name, string_view summary) {
+  return help_block(name, summary);
+}
+
+namespace {
+void wrap_line(string_view line, size_t width, string &dest) {
+  const size_t indent = min(line.find_first_not_of(' '), line.size());
+  if ((line.size() <= width) || (indent + 1 >= width)) {
+    dest.append(line);
+    return;
+  }
+
+  const string_view indentation = line.substr(0, indent);
+  string_view rest = line.substr(indent);
+  const size_t room = width - indent;
+  while (rest.size() > room) {
+    // Break at the last space that fits, or after an overlong word.
+    size_t brk = rest.rfind(' ', room);
+    if ((brk == string_view::npos) || (brk == 0)) {
+      brk = rest.find(' ', room);
+      if (brk == string_view::npos) {
+        break;
+      }
+    }
+    dest.append(indentation).append(rest.substr(0, brk));
+    rest.remove_prefix(min(rest.find_first_not_of(' ', brk), rest.size()));
+    if (rest.empty()) {
+      return;
+    }
+    dest.append("\n");
+  }
+  dest.append(indentation).append(rest);
+}
+} // namespace
+
+string wrap_text(string_view text, size_t width) {
+  if (width == 0) {
+    return string(text);
+  }
+  string result;
+  result.reserve(text.size() + text.size() / 8);
+  while (!text.empty()) {
+    const size_t eol = text.find('\n');
+    wrap_line(text.substr(0, eol), width, result);
+    if (eol == string_view::npos) {
+      break;
+    }
+    result.append("\n");
+    text.remove_prefix(eol + 1);
+  }
+  return result;
+}
+
 } // namespace ArgParse::Internal
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "name_trie.hpp"
+#include <algorithm>
+
+namespace ArgParse::Internal {
+
+namespace {
+size_t common_prefix_size(std::string_view lhs, std::string_view rhs) {
+  const auto mismatch =
+      std::mismatch(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  return static_cast<size_t>(mismatch.first - lhs.begin());
+}
+} // namespace
+
+NameTrie::NameTrie(std::pmr::memory_resource *resource) : m_nodes(resource) {
+  m_nodes.emplace_back();
+}
+
+void NameTrie::clear() {
+  m_nodes.clear();
+  m_nodes.emplace_back();
+}
+
+void NameTrie::reserve(size_t num_names) {
+  // Each name adds a leaf, and perhaps splits an edge.
+  m_nodes.reserve(2 * num_names + 1);
+}
+
+void NameTrie::insert(std::string_view name, size_t index) {
+  uint32_t node = 0;
+  size_t pos = 0;
+  while (true) {
+    // m_nodes may grow below, so don't hold references into it.
+    if (++m_nodes[node].num_names == 1) {
+      m_nodes[node].index = index;
+    }
+    if (pos == name.size()) {
+      m_nodes[node].has_name = true;
+      m_nodes[node].index = index;
+      return;
+    }
+
+    const uint32_t child = find_child(node, name[pos]);
+    const std::string_view rest = name.substr(pos);
+    if (child == no_node) {
+      Node leaf;
+      leaf.label = rest;
+      leaf.next_sibling = m_nodes[node].first_child;
+      leaf.num_names = 1;
+      leaf.has_name = true;
+      leaf.index = index;
+      m_nodes[node].first_child = static_cast<uint32_t>(m_nodes.size());
+      m_nodes.push_back(leaf);
+      return;
+    }
+
+    const std::string_view label = m_nodes[child].label;
+    const size_t common = common_prefix_size(label, rest);
+    if (common < label.size()) {
+      // Split the edge.  The child keeps its place among its siblings and
+      // becomes the node where the edge splits; its contents move below.
+      Node lower = m_nodes[child];
+      lower.label = label.substr(common);
+      lower.next_sibling = no_node;
+      Node &upper = m_nodes[child];
+      upper.label = label.substr(0, common);
+      upper.first_child = static_cast<uint32_t>(m_nodes.size());
+      upper.has_name = false;
+      m_nodes.push_back(lower);
+    }
+    node = child;
+    pos += common;
+  }
+}
+
+NameTrie::Match NameTrie::find(std::string_view key) const {
+  bool at_node = false;
+  const uint32_t node = walk(key, at_node);
+  if (node == no_node) {
+    return {};
+  }
+  const Node &found = m_nodes[node];
+  if (at_node && found.has_name) {
+    return {Match::Kind::exact, found.index};
+  }
+  switch (found.num_names) {
+  case 0:
+    return {};
+  case 1:
+    return {Match::Kind::abbreviation, found.index};
+  default:
+    return {Match::Kind::ambiguous, 0};
+  }
+}
+
+std::vector<size_t> NameTrie::find_all(std::string_view prefix) const {
+  std::vector<size_t> result;
+  bool at_node = false;
+  const uint32_t start = walk(prefix, at_node);
+  if (start == no_node) {
+    return result;
+  }
+  std::vector<uint32_t> pending{start};
+  while (!pending.empty()) {
+    const Node &node = m_nodes[pending.back()];
+    pending.pop_back();
+    if (node.has_name) {
+      result.push_back(node.index);
+    }
+    for (uint32_t child = node.first_child; child != no_node;
+         child = m_nodes[child].next_sibling) {
+      pending.push_back(child);
+    }
+  }
+  return result;
+}
+
+uint32_t NameTrie::find_child(uint32_t node, char first) const {
+  uint32_t child = m_nodes[node].first_child;
+  while ((child != no_node) && (m_nodes[child].label.front() != first)) {
+    child = m_nodes[child].next_sibling;
+  }
+  return child;
+}
+
+uint32_t NameTrie::walk(std::string_view key, bool &at_node) const {
+  uint32_t node = 0;
+  size_t pos = 0;
+  while (pos < key.size()) {
+    const uint32_t child = find_child(node, key[pos]);
+    if (child == no_node) {
+      return no_node;
+    }
+    const std::string_view label = m_nodes[child].label;
+    const size_t common = common_prefix_size(label, key.substr(pos));
+    if (common < label.size()) {
+      // Either key ends partway along the edge, or it diverges from it.
+      at_node = false;
+      return (pos + common == key.size()) ? child : no_node;
+    }
+    node = child;
+    pos += common;
+  }
+  at_node = true;
+  return node;
+}
+} // namespace ArgParse::Internal
@@ -0,0 +1,76 @@
+#include "output_sink.hpp"
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if !defined(_WIN32)
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace ArgParse {
+
+namespace {
+size_t terminal_width() {
+  if (const char *columns = std::getenv("COLUMNS")) {
+    size_t width = 0;
+    const char *end = columns + std::strlen(columns);
+    const auto [ptr, ec] = std::from_chars(columns, end, width);
+    if ((ec == std::errc()) && (ptr == end) && (width > 0)) {
+      return width;
+    }
+  }
+#if !defined(_WIN32)
+  struct winsize size {};
+  if (::isatty(STDOUT_FILENO) &&
+      (::ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0)) {
+    return size.ws_col;
+  }
+#endif
+  return 0;
+}
+
+class StreamSink : public OutputSink {
+public:
+  StreamSink(std::ostream &outs, std::ostream &errs, size_t width)
+      : m_outs(outs), m_errs(errs), m_width(width) {}
+
+  [[nodiscard]] size_t width() const override { return m_width; }
+
+  void write(Stream stream, std::string_view message) override {
+    std::ostream &dest = (stream == Stream::out) ? m_outs : m_errs;
+    dest.write(message.data(), static_cast<std::streamsize>(message.size()));
+    dest.flush();
+  }
+
+private:
+  std::ostream &m_outs;
+  std::ostream &m_errs;
+  const size_t m_width;
+};
+
+class DiscardSink : public OutputSink {
+public:
+  [[nodiscard]] bool discards() const override { return true; }
+
+  void write(Stream, std::string_view) override {}
+};
+} // namespace
+
+OutputSink::Ptr OutputSink::standard() {
+  // The terminal's width is looked up once, when first needed.
+  static const Ptr sink = create(std::cout, std::cerr, terminal_width());
+  return sink;
+}
+
+OutputSink::Ptr OutputSink::create(std::ostream &outs, std::ostream &errs,
+                                   size_t width) {
+  return std::make_shared<StreamSink>(outs, errs, width);
+}
+
+OutputSink::Ptr OutputSink::discard() {
+  static const Ptr sink = std::make_shared<DiscardSink>();
+  return sink;
+}
+} // namespace ArgParse
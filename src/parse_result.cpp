@@ -0,0 +1,30 @@
+#include "parse_result.hpp"
+#include "value_converter.hpp"
+
+namespace ArgParse {
+
+OptErrMsg ParseResult::error_msg() const {
+  if (!has_error()) {
+    return {};
+  }
+  return Internal::error_msg(m_error, m_name, m_value);
+}
+
+namespace Internal {
+std::string error_msg(ParseError error, std::string_view name,
+                      std::string_view value) {
+  switch (error) {
+  case ParseError::missing_value:
+    return "No value provided: '" + std::string(value) + "'";
+  case ParseError::incomplete_value:
+    return incomplete_conversion_msg(name, value);
+  case ParseError::out_of_range:
+    return out_of_range_msg(name, value);
+  case ParseError::none:
+  case ParseError::invalid_value:
+    break;
+  }
+  return invalid_value_msg(name, value);
+}
+} // namespace Internal
+} // namespace ArgParse
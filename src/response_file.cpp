@@ -0,0 +1,220 @@
+#include "response_file.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+
+#if defined(_WIN32)
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ArgParse::Internal {
+
+namespace {
+bool is_space(char c) {
+  return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r') ||
+         (c == '\f') || (c == '\v');
+}
+
+bool names_response_file(std::string_view arg) {
+  return (arg.size() > 1) && (arg.front() == '@');
+}
+
+#if !defined(_WIN32)
+[[noreturn]] void throw_errno(const std::string &path) {
+  throw std::system_error(errno, std::generic_category(), path);
+}
+
+// Closes a file descriptor when it goes out of scope.
+struct FileDescriptor {
+  const int m_fd;
+  ~FileDescriptor() {
+    if (m_fd >= 0) {
+      ::close(m_fd);
+    }
+  }
+};
+#endif
+} // namespace
+
+#if !defined(_WIN32)
+MappedFile::MappedFile(const std::string &path) {
+  const FileDescriptor file{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (file.m_fd < 0) {
+    throw_errno(path);
+  }
+
+  struct stat info {};
+  if (::fstat(file.m_fd, &info) != 0) {
+    throw_errno(path);
+  }
+  if (!S_ISREG(info.st_mode)) {
+    throw std::system_error(std::make_error_code(std::errc::invalid_argument),
+                            path);
+  }
+  m_id = {static_cast<unsigned long long>(info.st_dev),
+          static_cast<unsigned long long>(info.st_ino)};
+
+  // Empty files can't be mapped.
+  m_size = static_cast<size_t>(info.st_size);
+  if (m_size > 0) {
+    void *data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file.m_fd, 0);
+    if (data == MAP_FAILED) {
+      throw_errno(path);
+    }
+    ::madvise(data, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const char *>(data);
+  }
+}
+#else
+MappedFile::MappedFile(const std::string &path) {
+  std::ifstream ins(path, std::ios::binary);
+  if (!ins) {
+    throw std::system_error(
+        std::make_error_code(std::errc::no_such_file_or_directory), path);
+  }
+
+  // Without inode numbers, identify a file by its canonical path.
+  const auto canonical = std::filesystem::canonical(path).string();
+  m_id = {0, std::hash<std::string>()(canonical)};
+
+  m_size = static_cast<size_t>(std::filesystem::file_size(path));
+  m_buffer = std::make_unique<char[]>(m_size);
+  ins.read(m_buffer.get(), static_cast<std::streamsize>(m_size));
+  m_data = m_buffer.get();
+}
+#endif
+
+MappedFile::~MappedFile() { unmap(); }
+
+MappedFile::MappedFile(MappedFile &&src) noexcept
+    : m_data(src.m_data), m_size(src.m_size), m_id(src.m_id),
+      m_buffer(std::move(src.m_buffer)) {
+  src.m_data = nullptr;
+  src.m_size = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&src) noexcept {
+  if (this != &src) {
+    unmap();
+    m_data = src.m_data;
+    m_size = src.m_size;
+    m_id = src.m_id;
+    m_buffer = std::move(src.m_buffer);
+    src.m_data = nullptr;
+    src.m_size = 0;
+  }
+  return *this;
+}
+
+void MappedFile::unmap() {
+#if !defined(_WIN32)
+  if ((m_data != nullptr) && !m_buffer) {
+    ::munmap(const_cast<char *>(m_data), m_size);
+  }
+#endif
+  m_buffer.reset();
+  m_data = nullptr;
+  m_size = 0;
+}
+
+bool ResponseFiles::any_in(ArgCursor args) {
+  // The command name is never expanded.
+  if (!args.empty()) {
+    args.pop_front();
+  }
+  for (; !args.empty(); args.pop_front()) {
+    if (names_response_file(args.front())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+OptErrMsg ResponseFiles::expand(ArgCursor &args) {
+  clear();
+  m_args.reserve(args.size());
+  if (!args.empty()) {
+    m_args.push_back(args.front());
+    args.pop_front();
+  }
+  for (; !args.empty(); args.pop_front()) {
+    if (auto err_msg = expand_arg(args.front())) {
+      return err_msg;
+    }
+  }
+  return {};
+}
+
+void ResponseFiles::clear() {
+  m_args.clear();
+  m_files.clear();
+  m_active.clear();
+}
+
+OptErrMsg ResponseFiles::expand_arg(std::string_view arg) {
+  if (names_response_file(arg)) {
+    return expand_file(arg.substr(1));
+  }
+  m_args.push_back(arg);
+  return {};
+}
+
+// On failure this leaves m_active as it is; the next expand() clears it.
+OptErrMsg ResponseFiles::expand_file(std::string_view path) {
+  const std::string path_str(path);
+  try {
+    m_files.emplace_back(path_str);
+  } catch (const std::system_error &e) {
+    return "Cannot read response file '" + path_str +
+           "': " + e.code().message() + ".";
+  }
+
+  // Nested expansions may grow m_files, so don't hold a reference into it.
+  const MappedFile::Id id = m_files.back().id();
+  const std::string_view contents = m_files.back().contents();
+  if (std::find(m_active.begin(), m_active.end(), id) != m_active.end()) {
+    return "Response file '" + path_str + "' includes itself.";
+  }
+  m_active.push_back(id);
+
+  const size_t size = contents.size();
+  size_t pos = 0;
+  while (true) {
+    while ((pos < size) && is_space(contents[pos])) {
+      ++pos;
+    }
+    if (pos == size) {
+      break;
+    }
+
+    const char first = contents[pos];
+    if ((first == '"') || (first == '\'')) {
+      const size_t close = contents.find(first, pos + 1);
+      if (close == std::string_view::npos) {
+        return "Unterminated quote in response file '" + path_str + "'.";
+      }
+      m_args.push_back(contents.substr(pos + 1, close - pos - 1));
+      pos = close + 1;
+    } else {
+      size_t end = pos;
+      while ((end < size) && !is_space(contents[end])) {
+        ++end;
+      }
+      if (auto err_msg = expand_arg(contents.substr(pos, end - pos))) {
+        return err_msg;
+      }
+      pos = end;
+    }
+  }
+
+  m_active.pop_back();
+  return {};
+}
+} // namespace ArgParse::Internal
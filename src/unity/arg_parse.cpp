@@ -0,0 +1,18 @@
+// The whole library as a single translation unit, for the arg_parse_unity
+// target.  Compiling it as part of a program lets the compiler inline across
+// the library, and lets link-time optimization treat it as the program's own
+// code.  Keep this in step with SOURCES in the top-level CMakeLists.txt.
+#include "../argument_parser.cpp"
+#include "../choice.cpp"
+#include "../command_line.cpp"
+#include "../completion_cache.cpp"
+#include "../config_file.cpp"
+#include "../edit_distance.cpp"
+#include "../env_index.cpp"
+#include "../flag.cpp"
+#include "../help_fmt.cpp"
+#include "../name_trie.cpp"
+#include "../output_sink.cpp"
+#include "../parse_result.cpp"
+#include "../response_file.cpp"
+#include "../value_converter.cpp"
@@ -2,14 +2,19 @@
 
 namespace ArgParse::Internal {
 std::string invalid_value_msg(std::string_view name, std::string_view sval) {
-  return std::string("Invalid value for '") + name.data() + "': '" +
-         sval.data() + "'.";
+  return std::string("Invalid value for '") + std::string(name) + "': '" +
+         std::string(sval) + "'.";
 }
 
 std::string incomplete_conversion_msg(std::string_view name,
                                       std::string_view sval) {
-  return std::string("Could not completely convert value for '") + name.data() +
-         "': '" + sval.data() + "'.";
+  return std::string("Could not completely convert value for '") +
+         std::string(name) + "': '" + std::string(sval) + "'.";
 }
 
-} // namespace ArgParse::Internal
\ No newline at end of file
+std::string out_of_range_msg(std::string_view name, std::string_view sval) {
+  return std::string("Value out of range for '") + std::string(name) +
+         "': '" + std::string(sval) + "'.";
+}
+
+} // namespace ArgParse::Internal
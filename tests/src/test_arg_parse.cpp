@@ -1,11 +1,27 @@
 #include "arg_parse.hpp"
 #include "arg_parse_result.hpp"
+#include "config_file.hpp"
+#include "edit_distance.hpp"
+#include "env_index.hpp"
+#include "flag_bits.hpp"
+#include "name_trie.hpp"
+#include "spec_table.hpp"
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory_resource>
+#include <new>
+#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 TEST_CASE("Invalid invocation") {
   using namespace ArgParse;
@@ -75,6 +91,168 @@ TEST_CASE("Show help") {
   std::cout << "DEBUG: help output:" << std::endl << apr.cout();
 }
 
+TEST_CASE("Help text is cached") {
+  using namespace ArgParse;
+
+  auto parser = ArgumentParser::create("Show help repeatedly.");
+  flag(parser, "-v", "--verbose", "Be verbose.");
+  const ArgSeq args{"<exe>", "--help"};
+
+  Tests::ArgParseResult first(parser, args, true, 0);
+  CHECK(first.check_outcome());
+  parser->reset();
+  Tests::ArgParseResult second(parser, args, true, 0);
+  CHECK(second.check_outcome());
+  CHECK(first.cout() == second.cout());
+
+  SECTION("Adding specs updates the text") {
+    parser->reset();
+    option<int>(parser, "-n", "--count", "How many.");
+    argument<std::string>(parser, "files", Nargs::zero_or_more, "Files.");
+    Tests::ArgParseResult apr(parser, args, true, 0);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cout_contains("[-n|--count COUNT]"));
+    CHECK(apr.cout_contains("[FILES ...]"));
+    CHECK(apr.cout_contains("How many."));
+  }
+
+  SECTION("Errors show the same usage") {
+    parser->reset();
+    Tests::ArgParseResult apr(parser, {"<exe>", "--bogus"}, true, 1);
+    CHECK(apr.check_outcome());
+    const std::string_view help(first.cout());
+    const auto usage = help.substr(help.find("Usage:"));
+    CHECK(apr.cerr_contains(usage));
+  }
+}
+
+namespace {
+// Records each message written to it.
+struct CaptureSink : public ArgParse::OutputSink {
+  std::vector<std::string> m_outs;
+  std::vector<std::string> m_errs;
+
+  void write(Stream stream, std::string_view message) override {
+    auto &dest = (stream == Stream::out) ? m_outs : m_errs;
+    dest.emplace_back(message);
+  }
+};
+} // namespace
+
+TEST_CASE("Output sinks") {
+  using namespace ArgParse;
+
+  auto parser = ArgumentParser::create("Send output to a sink.");
+  auto sink = std::make_shared<CaptureSink>();
+  parser->set_output(sink);
+  option<int>(parser, "-n", "--count", "How many.");
+
+  SECTION("Help is written at once") {
+    const std::vector<std::string_view> args{"<exe>", "--help"};
+    parser->parse_args(args);
+    CHECK(parser->exit_code() == 0);
+    REQUIRE(sink->m_outs.size() == 1);
+    CHECK(sink->m_errs.empty());
+    CHECK(sink->m_outs[0].starts_with("Send output to a sink.\n"));
+    CHECK(sink->m_outs[0].find("--count COUNT") != std::string::npos);
+    CHECK(sink->m_outs[0].ends_with("How many.\n"));
+  }
+
+  SECTION("Errors are written at once") {
+    const std::vector<std::string_view> args{"<exe>", "--count=x"};
+    parser->parse_args(args);
+    CHECK(parser->exit_code() == 1);
+    CHECK(sink->m_outs.empty());
+    REQUIRE(sink->m_errs.size() == 1);
+    CHECK(sink->m_errs[0].starts_with("Error: "));
+    CHECK(sink->m_errs[0].find("Usage: <exe>") != std::string::npos);
+  }
+
+  SECTION("Compiled parsers and subparsers share the sink") {
+    const std::vector<std::string_view> args{"<exe>", "--help"};
+    const auto context = parser->compile()->parse_args(args);
+    CHECK(context.should_exit());
+    CHECK(sink->m_outs.size() == 1);
+
+    auto with_commands = ArgumentParser::create("Has commands.");
+    with_commands->set_output(sink);
+    with_commands->add_subcommand("run", "Run it.", [](ArgumentParser::Ptr) {});
+    const std::vector<std::string_view> run_help{"<exe>", "run", "--help"};
+    with_commands->parse_args(run_help);
+    REQUIRE(sink->m_outs.size() == 2);
+    CHECK(sink->m_outs[1].starts_with("Run it.\n"));
+  }
+
+  SECTION("Help is wrapped to the sink's width") {
+    std::ostringstream outs;
+    std::ostringstream errs;
+    parser->set_output(OutputSink::create(outs, errs, 40));
+    flag(parser, "-q", "--quiet",
+         "Say nothing at all, not even when something goes badly wrong, "
+         "unless asked to with a separate flag.");
+    const std::vector<std::string_view> args{"<exe>", "--help"};
+    parser->parse_args(args);
+    CHECK(errs.str().empty());
+
+    const std::string help = outs.str();
+    const auto sections = help.substr(help.find("Options:"));
+    std::istringstream lines(sections);
+    std::string line;
+    size_t num_lines = 0;
+    while (std::getline(lines, line)) {
+      CHECK(line.size() <= 40);
+      ++num_lines;
+    }
+    CHECK(num_lines > 8);
+    CHECK(sections.find("\n        unless asked to") != std::string::npos);
+  }
+}
+
+TEST_CASE("Error records") {
+  using namespace ArgParse;
+
+  auto count = Option<int>::create("-n", "--count", "How many.");
+
+  SECTION("Invalid values are recorded, not formatted") {
+    const auto result = count->parse_value("--count=x", "x");
+    CHECK(result.matched());
+    CHECK(result.has_error());
+    CHECK(result.error() == ParseError::invalid_value);
+    CHECK(result.error_msg().value() == "Invalid value for '--count=x': 'x'.");
+  }
+
+  SECTION("Missing values") {
+    const auto result =
+        ParseResult::match_with_error(ParseError::missing_value, "-n", "-n");
+    CHECK(result.error() == ParseError::missing_value);
+    CHECK(result.error_msg().value() == "No value provided: '-n'");
+  }
+
+  SECTION("Successful parses have no error") {
+    const auto result = count->parse_value("-n", "3");
+    CHECK(result.matched());
+    CHECK(!result.has_error());
+    CHECK(!result.error_msg());
+  }
+
+  SECTION("Discarded errors") {
+    auto parser = ArgumentParser::create("Try a command line.");
+    parser->set_output(OutputSink::discard());
+    parser->add_option(count);
+    argument<int>(parser, "n", Nargs::one, "A number.");
+
+    for (const auto &args : std::vector<ArgSeq>{{"<exe>", "-n", "x", "1"},
+                                                {"<exe>", "--bogus", "1"},
+                                                {"<exe>", "1", "2"},
+                                                {"<exe>"}}) {
+      parser->reset();
+      Tests::ArgParseResult apr(parser, args, true, 1);
+      CHECK(apr.check_outcome());
+      CHECK(apr.cerr().empty());
+    }
+  }
+}
+
 TEST_CASE("Invoke no args") {
   using namespace ArgParse;
 
@@ -222,6 +400,32 @@ TEST_CASE("Using Flags and Options") {
       CHECK(apr.cerr_contains("Unknown option"));
       CHECK(apr.cerr_contains("--number"));
     }
+
+    SECTION("Invoke with long option name plus suffix") {
+      ArgSeq args{"<exe>", "--outputs", "foo.txt"};
+      Tests::ArgParseResult apr(parser, args, true, 1);
+      CHECK(apr.check_outcome());
+      CHECK(apr.cerr_contains("Unknown option '--outputs'"));
+      CHECK(output->value() == std::filesystem::path("some_location.txt"));
+    }
+
+    SECTION("Add option with duplicate name") {
+      auto dup_short =
+          Option<int>::create("-o", "--other", "Reuses a short name");
+      auto dup_long = Flag::create("-x", "--output", "Reuses a long name");
+      auto dup_help = Flag::create("-h", "--hidden", "Reuses the help flag");
+      CHECK_THROWS_AS(parser->add_option(dup_short), std::invalid_argument);
+      CHECK_THROWS_AS(parser->add_option(dup_long), std::invalid_argument);
+      CHECK_THROWS_AS(parser->add_option(dup_help), std::invalid_argument);
+
+      // Rejected options must not claim any names.
+      auto x_flag = Flag::create("-x", "--x-flag", "Uses a free short name");
+      parser->add_option(x_flag);
+      ArgSeq args{"<exe>", "-x"};
+      parser->parse_args(args);
+      CHECK(!parser->should_exit());
+      CHECK(x_flag->is_set());
+    }
   }
 
   SECTION("Using default flags and options") {
@@ -244,6 +448,255 @@ TEST_CASE("Using Flags and Options") {
   }
 }
 
+TEST_CASE("Long option abbreviations") {
+  using namespace ArgParse;
+
+  SECTION("Name tries") {
+    Internal::NameTrie trie;
+    trie.insert("--output", 0);
+    trie.insert("--out", 1);
+    trie.insert("--offset", 2);
+    trie.insert("--verbose", 3);
+    using Kind = Internal::NameTrie::Match::Kind;
+    CHECK(trie.find("--out").kind == Kind::exact);
+    CHECK(trie.find("--out").index == 1);
+    CHECK(trie.find("--outp").kind == Kind::abbreviation);
+    CHECK(trie.find("--outp").index == 0);
+    CHECK(trie.find("--of").index == 2);
+    CHECK(trie.find("--v").index == 3);
+    CHECK(trie.find("--o").kind == Kind::ambiguous);
+    CHECK(trie.find("--ou").kind == Kind::ambiguous);
+    CHECK(trie.find("--outputs").kind == Kind::none);
+    CHECK(trie.find("--x").kind == Kind::none);
+    auto all = trie.find_all("--o");
+    std::sort(all.begin(), all.end());
+    CHECK(all == std::vector<size_t>{0, 1, 2});
+    CHECK(trie.find_all("--q").empty());
+  }
+
+  auto parser = ArgumentParser::create("Abbreviate some options.");
+  auto output = option<std::string>(parser, "-o", "--output", "Output.");
+  auto offset = option<int>(parser, "", "--offset", "Offset.");
+  auto verbose = flag(parser, "-v", "--verbose", "Verbose.");
+
+  SECTION("Unique prefixes") {
+    parser->parse_args(ArgSeq{"<exe>", "--outp", "a.txt", "--of=3", "--verb"});
+    CHECK(!parser->should_exit());
+    CHECK(output->value() == "a.txt");
+    CHECK(offset->value() == 3);
+    CHECK(verbose->is_set());
+  }
+
+  SECTION("Errors name the option as given") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "--off", "x"}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains("Invalid value for '--off': 'x'"));
+  }
+
+  SECTION("Ambiguous prefixes") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "--o=a.txt"}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains(
+        "Ambiguous option '--o=a.txt' (could be --offset, --output)"));
+  }
+
+  SECTION("Flags take no value") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "--verb=1"}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains("Unknown option '--verb=1'"));
+  }
+
+  SECTION("Options match only their own names") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "--outputs", "a.txt"}, true,
+                              1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains("Unknown option '--outputs'"));
+
+    parser->reset();
+    parser->parse_args(ArgSeq{"<exe>", "--output=a.txt"});
+    CHECK(!parser->should_exit());
+    CHECK(output->value() == "a.txt");
+  }
+
+  SECTION("Compiled parsers") {
+    const auto compiled = parser->compile();
+    const std::vector<std::string_view> args{"<exe>", "--offs", "7"};
+    const auto context = compiled->parse_args(args);
+    CHECK(!context.should_exit());
+    CHECK(context.value(offset) == 7);
+  }
+}
+
+TEST_CASE("Suggestions for unknown options") {
+  using namespace ArgParse;
+
+  SECTION("Edit distances") {
+    const Internal::EditDistance distance("kitten");
+    CHECK(distance.to("kitten", 3) == 0);
+    CHECK(distance.to("sitting", 3) == 3);
+    CHECK(!distance.to("sitting", 2));
+    CHECK(distance.to("", 6) == 6);
+    CHECK(Internal::EditDistance("").to("abc", 3) == 3);
+    const std::string long_pattern(Internal::EditDistance::max_size, 'a');
+    CHECK(Internal::EditDistance(long_pattern).to("a", 100) == 63);
+  }
+
+  SECTION("Nearest names") {
+    const std::vector<std::string_view> names{"--output", "--outputs",
+                                              "--offset", "-o"};
+    using Internal::nearest_names;
+    CHECK(nearest_names("--outpt", names, 2) ==
+          std::vector<std::string_view>{"--output"});
+    CHECK(nearest_names("--outputz", names, 2) ==
+          std::vector<std::string_view>{"--output", "--outputs"});
+    CHECK(nearest_names("--verbose", names, 2).empty());
+  }
+
+  auto parser = ArgumentParser::create("Suggest some options.");
+  auto output = option<std::string>(parser, "-o", "--output", "Output.");
+  auto verbose = flag(parser, "-v", "--verbose", "Verbose.");
+
+  SECTION("Near misses") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "--verbsoe"}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains(
+        "Unknown option '--verbsoe' (did you mean --verbose?)"));
+  }
+
+  SECTION("Values are ignored") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "--outptu=a.txt"}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains(
+        "Unknown option '--outptu=a.txt' (did you mean --output?)"));
+  }
+
+  SECTION("Distant names aren't suggested") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "--quiet"}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains("Unknown option '--quiet'\n"));
+  }
+
+  SECTION("Short names aren't suggested") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "-x"}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains("Unknown option '-x'\n"));
+  }
+}
+
+TEST_CASE("Short option clusters") {
+  using namespace ArgParse;
+
+  SECTION("Flag bits") {
+    Internal::FlagBits bits;
+    for (size_t i = 0; i < 130; ++i) {
+      CHECK(bits.add() == i);
+    }
+    bits.set(0, true);
+    bits.set(64, true);
+    bits.set(129, true);
+    bits.set(64, false);
+    CHECK(bits.test(0));
+    CHECK(!bits.test(1));
+    CHECK(!bits.test(64));
+    CHECK(bits.test(129));
+  }
+
+  auto parser = ArgumentParser::create("Cluster some flags.");
+  auto extract = flag(parser, "-x", "--extract", "Extract.");
+  auto verbose = flag(parser, "-v", "--verbose", "Verbose.");
+  auto file = option<std::string>(parser, "-f", "--file", "Archive.");
+  auto level = option<int>(parser, "-l", "--level", "Level.", 0);
+
+  SECTION("Flags") {
+    parser->parse_args(ArgSeq{"<exe>", "-vx"});
+    CHECK(!parser->should_exit());
+    CHECK(extract->is_set());
+    CHECK(verbose->is_set());
+    CHECK(file->value().empty());
+  }
+
+  SECTION("Single-character long names") {
+    auto long_only = Option<int>::create("", "-y", "Only a long name.", 0);
+    parser->add_option(long_only);
+    parser->parse_args(ArgSeq{"<exe>", "-y", "5", "-v"});
+    CHECK(!parser->should_exit());
+    CHECK(long_only->value() == 5);
+    CHECK(verbose->is_set());
+  }
+
+  SECTION("Short names take no =value") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "-f=out.tar"}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains("Unknown option '-f=out.tar'"));
+    CHECK(file->value().empty());
+
+    parser->reset();
+    Tests::ArgParseResult clustered(parser, {"<exe>", "-xf=out.tar"}, true,
+                                    1);
+    CHECK(clustered.check_outcome());
+    CHECK(!extract->is_set());
+  }
+
+  SECTION("A trailing option takes the rest of the cluster") {
+    parser->parse_args(ArgSeq{"<exe>", "-xvfout.tar", "-l9"});
+    CHECK(!parser->should_exit());
+    CHECK(extract->is_set());
+    CHECK(verbose->is_set());
+    CHECK(file->value() == "out.tar");
+    CHECK(level->value() == 9);
+  }
+
+  SECTION("A trailing option takes the next argument") {
+    parser->parse_args(ArgSeq{"<exe>", "-xvf", "out.tar"});
+    CHECK(!parser->should_exit());
+    CHECK(verbose->is_set());
+    CHECK(file->value() == "out.tar");
+  }
+
+  SECTION("Errors name the option within the cluster") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "-xl"}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains("No value provided: '-l'"));
+
+    Tests::ArgParseResult invalid(parser, {"<exe>", "-vlx"}, true, 1);
+    CHECK(invalid.check_outcome());
+    CHECK(invalid.cerr_contains("Invalid value for '-l': 'x'"));
+  }
+
+  SECTION("Unknown names spoil the whole cluster") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "-xqv"}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains("Unknown option '-xqv'"));
+    CHECK(!extract->is_set());
+    CHECK(!verbose->is_set());
+  }
+
+  SECTION("The help flag may be clustered") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "-vh"}, true, 0);
+    CHECK(apr.check_outcome());
+  }
+
+  SECTION("Flags keep their state when added to a parser") {
+    auto early = Flag::create("-e", "--early", "Set before being added.");
+    CHECK(early->parse_value("--early", "true").matched());
+    parser->add_option(early);
+    CHECK(early->is_set());
+    parser->reset();
+    CHECK(!early->is_set());
+  }
+
+  SECTION("Compiled parsers") {
+    const auto compiled = parser->compile();
+    const std::vector<std::string_view> args{"<exe>", "-vf", "a.tar"};
+    const auto context = compiled->parse_args(args);
+    CHECK(!context.should_exit());
+    CHECK(context.is_set(verbose));
+    CHECK(!context.is_set(extract));
+    CHECK(context.value(file) == "a.tar");
+    CHECK(!verbose->is_set());
+  }
+}
+
 namespace {
 using namespace ArgParse;
 auto create_no_option() {
@@ -303,6 +756,217 @@ TEST_CASE("Choices") {
 
 // TODO test for redundant setting of flags/options/arguments.
 
+TEST_CASE("Enum choices") {
+  using namespace ArgParse;
+
+  enum class Codec { h264, hevc, av1 };
+
+  SECTION("Choice tables") {
+    const std::vector<std::string_view> names{"Beta", "alpha", "ALPHA", "b"};
+    const Internal::ChoiceTable table(names, std::pmr::get_default_resource());
+    CHECK(table.find("beta") == 0);
+    CHECK(table.find("Alpha") == 1);
+    CHECK(table.find("B") == 3);
+    CHECK(!table.find("bet"));
+    CHECK(!table.find("betas"));
+    CHECK(!table.find(""));
+  }
+
+  auto parser = ArgumentParser::create("Choose a codec.");
+  auto codec = enum_choice<Codec>(
+      parser, "-c", "--codec", "Video codec.",
+      {{"h264", Codec::h264}, {"HEVC", Codec::hevc}, {"av1", Codec::av1}});
+
+  SECTION("Default") {
+    parser->parse_args(ArgSeq{"<exe>"});
+    CHECK(!parser->should_exit());
+    CHECK(codec->value() == Codec::h264);
+  }
+
+  SECTION("Names are matched regardless of case") {
+    parser->parse_args(ArgSeq{"<exe>", "--codec=hevc"});
+    CHECK(!parser->should_exit());
+    CHECK(codec->value() == Codec::hevc);
+  }
+
+  SECTION("Invalid names") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "-c", "vp9"}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains("Invalid value for '-c': 'vp9'"));
+  }
+
+  SECTION("Help lists the names") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "-h"}, true, 0);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cout_contains("('h264', 'HEVC', 'av1')"));
+  }
+
+  SECTION("Compiled parsers") {
+    const auto compiled = parser->compile();
+    const std::vector<std::string_view> args{"<exe>", "-c", "AV1"};
+    const auto context = compiled->parse_args(args);
+    CHECK(!context.should_exit());
+    CHECK(context.value(codec) == Codec::av1);
+    CHECK(codec->value() == Codec::h264);
+  }
+
+  SECTION("Indices") {
+    auto region =
+        enum_choice<size_t>(parser, "-r", "--region", "Region.",
+                            {{"us-east", 0}, {"eu-west", 1}, {"ap-south", 2}});
+    parser->parse_args(ArgSeq{"<exe>", "-r", "EU-WEST"});
+    CHECK(region->value() == 1);
+  }
+
+  SECTION("No choices") {
+    CHECK_THROWS_AS(EnumChoice<Codec>::create("-x", "--x", "None.", {}),
+                    std::invalid_argument);
+  }
+}
+
+namespace {
+// An option that implements IOption itself, so a parser calls it through the
+// default dispatch.  It counts how often it is given, e.g., "-vvv".
+struct Counter : public ArgParse::IOption {
+  using value_type = int;
+
+  explicit Counter(std::string_view short_name) : m_short(short_name) {}
+
+  [[nodiscard]] std::string usage() const override { return m_short; }
+  [[nodiscard]] std::string help() const override { return m_short; }
+  [[nodiscard]] std::string_view short_name() const override {
+    return m_short;
+  }
+  [[nodiscard]] std::string_view long_name() const override { return {}; }
+  [[nodiscard]] bool takes_value() const override { return false; }
+  [[nodiscard]] std::vector<std::string> value_candidates() const override {
+    return {};
+  }
+  [[nodiscard]] ArgParse::SpecState initial_state() const override {
+    return 0;
+  }
+  void set_env_var(std::string_view name) override {}
+  [[nodiscard]] std::string_view env_var() const override { return {}; }
+  ArgParse::ParseResult parse_value(std::string_view source,
+                                    std::string_view value) override {
+    ++m_count;
+    return ArgParse::ParseResult::match();
+  }
+  ArgParse::ParseResult parse_value(std::string_view source,
+                                    std::string_view value,
+                                    ArgParse::SpecState &state) const override {
+    ++std::any_cast<int &>(state);
+    return ArgParse::ParseResult::match();
+  }
+  void reset() override { m_count = 0; }
+
+  std::string m_short;
+  int m_count{0};
+};
+} // namespace
+
+TEST_CASE("Spec tables") {
+  using namespace ArgParse;
+
+  auto *resource = std::pmr::get_default_resource();
+  auto bits = std::make_shared<Internal::FlagBits>(resource);
+  auto verbose = Flag::create("-v", "--verbose", "Be verbose.");
+  auto count = Option<int>::create("-n", "--count", "How many.", 3);
+  auto mode = Choice::create("-m", "--mode", "Mode.", {"fast", "slow"});
+  auto level = EnumChoice<int>::create("-l", "--level", "Level.",
+                                       {{"low", 0}, {"high", 1}});
+  auto counter = std::make_shared<Counter>("-c");
+
+  Internal::OptionTable options(resource);
+  options.add(verbose, static_cast<uint32_t>(verbose->store_in(bits)));
+  options.add(count, Internal::OptionTable::no_bit);
+  options.add(mode, Internal::OptionTable::no_bit);
+  options.add(level, Internal::OptionTable::no_bit);
+  options.add(counter, Internal::OptionTable::no_bit);
+
+  SECTION("Columns") {
+    REQUIRE(options.size() == 5);
+    CHECK(options.short_name(1) == "-n");
+    CHECK(options.long_name(2) == "--mode");
+    CHECK(options.kind(0) == Internal::OptionKind::flag);
+    CHECK(options.kind(1) == Internal::OptionKind::option);
+    CHECK(options.kind(2) == Internal::OptionKind::choice);
+    CHECK(options.kind(3) == Internal::OptionKind::choice);
+    CHECK(options.kind(4) == Internal::OptionKind::flag);
+    CHECK(!options.takes_value(0));
+    CHECK(options.takes_value(3));
+    CHECK(options.flag_bit(0) == 0);
+    CHECK(options.flag_bit(1) == Internal::OptionTable::no_bit);
+  }
+
+  SECTION("Dispatch") {
+    CHECK(!options.parse_value(0, "-v", "true").has_error());
+    CHECK(verbose->is_set());
+    CHECK(!options.parse_value(1, "-n", "7").has_error());
+    CHECK(count->value() == 7);
+    CHECK(options.parse_value(2, "-m", "medium").has_error());
+    CHECK(!options.parse_value(3, "-l", "HIGH").has_error());
+    CHECK(level->value() == 1);
+    CHECK(!options.parse_value(4, "-c", "true").has_error());
+    CHECK(counter->m_count == 1);
+
+    SpecState state = count->initial_state();
+    CHECK(!options.parse_value(1, "-n", "9", state).has_error());
+    CHECK(std::any_cast<int>(state) == 9);
+    CHECK(count->value() == 7);
+  }
+
+  SECTION("Arguments") {
+    auto values = Argument<int>::create("values", Nargs::one_or_more, "Ints.");
+    Internal::ArgumentTable args(resource);
+    args.add(values);
+    CHECK(args.nargs(0) == Nargs::one_or_more);
+
+    const std::vector<std::string_view> tokens{"4", "5"};
+    ArgCursor cursor(tokens);
+    CHECK(args.parse(0, cursor).matched());
+    CHECK(args.parse(0, cursor).matched());
+    CHECK(cursor.empty());
+    CHECK(values->values() == std::vector<int>{4, 5});
+  }
+
+  SECTION("Flags shared between parsers") {
+    auto shared = Flag::create("-x", "--extract", "Extract.");
+    auto first = ArgumentParser::create("First.");
+    auto second = ArgumentParser::create("Second.");
+    first->add_option(shared);
+    second->add_option(shared);
+
+    first->parse_args(ArgSeq{"<exe>", "-x"});
+    CHECK(!first->should_exit());
+    CHECK(shared->is_set());
+
+    shared->reset();
+    second->parse_args(ArgSeq{"<exe>", "--extract"});
+    CHECK(shared->is_set());
+
+    const auto compiled = first->compile();
+    const std::vector<std::string_view> args{"<exe>", "-x"};
+    const auto context = compiled->parse_args(args);
+    CHECK(context.is_set(shared));
+  }
+
+  SECTION("Options with the default dispatch") {
+    auto parser = ArgumentParser::create("Count.");
+    auto repeats = std::make_shared<Counter>("-c");
+    parser->add_option(repeats);
+    parser->parse_args(ArgSeq{"<exe>", "-c", "-cc"});
+    CHECK(!parser->should_exit());
+    CHECK(repeats->m_count == 3);
+
+    const auto compiled = parser->compile();
+    const std::vector<std::string_view> args{"<exe>", "-c", "-c"};
+    const auto context = compiled->parse_args(args);
+    CHECK(!context.should_exit());
+    CHECK(context.value(repeats) == 2);
+  }
+}
+
 TEST_CASE("Positionals") {
   using namespace ArgParse;
 
@@ -464,6 +1128,125 @@ TEST_CASE("Detect invalid values") {
   }
 }
 
+namespace {
+struct Point {
+  int x{0};
+  int y{0};
+};
+} // namespace
+
+template <> struct ArgParse::ValueTraits<Point> {
+  static Conversion from_string(std::string_view sval, Point &value) {
+    const auto comma = sval.find(',');
+    if (comma == std::string_view::npos) {
+      return Conversion::invalid;
+    }
+    const auto x_status = Internal::convert(sval.substr(0, comma), value.x);
+    if (x_status != Conversion::ok) {
+      return x_status;
+    }
+    return Internal::convert(sval.substr(comma + 1), value.y);
+  }
+};
+
+TEST_CASE("Value conversion") {
+  using namespace ArgParse;
+  using Internal::ValueConverter;
+
+  SECTION("Integers") {
+    CHECK(ValueConverter<int>("n", "42").m_value == 42);
+    CHECK(ValueConverter<int>("n", "+42").m_value == 42);
+    CHECK(ValueConverter<int>("n", "-42").m_value == -42);
+    CHECK(ValueConverter<int>("n", "010").m_value == 10);
+    CHECK(ValueConverter<int>("n", "0x1F").m_value == 31);
+    CHECK(ValueConverter<int>("n", "-0x10").m_value == -16);
+    CHECK(ValueConverter<int>("n", "0o17").m_value == 15);
+    CHECK(ValueConverter<int>("n", "0b101").m_value == 5);
+    CHECK(ValueConverter<int16_t>("n", "-32768").m_value == -32768);
+    CHECK(ValueConverter<uint64_t>("n", "18446744073709551615").m_value ==
+          18446744073709551615ULL);
+  }
+
+  SECTION("Invalid integers") {
+    const auto msg = [](std::string_view sval) {
+      return ValueConverter<int16_t>("n", sval).error_msg().value_or("");
+    };
+    CHECK(msg("").starts_with("Invalid value"));
+    CHECK(msg("-").starts_with("Invalid value"));
+    CHECK(msg("0x").starts_with("Could not completely convert"));
+    CHECK(msg("0xg").starts_with("Invalid value"));
+    CHECK(msg("12 ").starts_with("Could not completely convert"));
+    CHECK(msg("32768").starts_with("Value out of range"));
+    CHECK(msg("-32769").starts_with("Value out of range"));
+    CHECK(msg("99999999999999999999").starts_with("Value out of range"));
+    CHECK(ValueConverter<unsigned>("n", "-1")
+              .error_msg().value_or("")
+              .starts_with("Value out of range"));
+    CHECK(!ValueConverter<unsigned>("n", "-0").failed());
+  }
+
+  SECTION("Leading whitespace") {
+    // Skipped, as operator>> skips it.
+    CHECK(ValueConverter<int>("n", " 5").m_value == 5);
+    CHECK(ValueConverter<int>("n", "\t-0x10").m_value == -16);
+    CHECK(ValueConverter<double>("x", "  1.5").m_value == 1.5);
+    CHECK(ValueConverter<bool>("b", " 1").m_value);
+    CHECK(ValueConverter<int>("n", "  ").failed());
+    CHECK(ValueConverter<int>("n", "- 5").failed());
+  }
+
+  SECTION("Floating point") {
+    CHECK(ValueConverter<double>("x", "1.5").m_value == 1.5);
+    CHECK(ValueConverter<double>("x", "+1.5e3").m_value == 1500.0);
+    CHECK(ValueConverter<double>("x", "-2").m_value == -2.0);
+    CHECK(ValueConverter<double>("x", "0x1p4").m_value == 16.0);
+    CHECK(ValueConverter<float>("x", "0.25").m_value == 0.25f);
+    CHECK(ValueConverter<double>("x", "+-1").failed());
+    CHECK(ValueConverter<double>("x", "1.5.")
+              .error_msg().value_or("")
+              .starts_with("Could not completely convert"));
+    CHECK(ValueConverter<double>("x", "1e999")
+              .error_msg().value_or("")
+              .starts_with("Value out of range"));
+  }
+
+  SECTION("Booleans") {
+    CHECK(ValueConverter<bool>("b", "1").m_value);
+    CHECK(!ValueConverter<bool>("b", "0").m_value);
+    CHECK(ValueConverter<bool>("b", "2").failed());
+    CHECK(ValueConverter<bool>("b", "10").failed());
+  }
+
+  SECTION("Not NUL-terminated") {
+    const std::string_view digits("12345", 2);
+    CHECK(ValueConverter<int>("n", digits).m_value == 12);
+    CHECK(ValueConverter<char>("c", "xyz").failed());
+    CHECK(ValueConverter<char>("c", std::string_view("xyz", 1)).m_value ==
+          'x');
+  }
+
+  SECTION("Custom ValueTraits") {
+    auto parser = ArgumentParser::create("Parse some points.");
+    auto origin = Option<Point>::create("-p", "--point", "A point");
+    parser->add_option(origin);
+
+    SECTION("Valid") {
+      ArgSeq args{"<exe>", "--point=3,-4"};
+      parser->parse_args(args);
+      CHECK(!parser->should_exit());
+      CHECK(origin->value().x == 3);
+      CHECK(origin->value().y == -4);
+    }
+
+    SECTION("Invalid") {
+      ArgSeq args{"<exe>", "--point=3"};
+      Tests::ArgParseResult apr(parser, args, true, 1);
+      CHECK(apr.check_outcome());
+      CHECK(apr.cerr_contains("Invalid value for '--point=3': '3'."));
+    }
+  }
+}
+
 TEST_CASE("Using argc, argv") {
   using namespace ArgParse;
 
@@ -501,6 +1284,41 @@ TEST_CASE("Using argc, argv") {
   }
 }
 
+TEST_CASE("Using a span of string_views") {
+  using namespace ArgParse;
+
+  auto parser = ArgumentParser::create("test the span interface");
+  auto output = Option<std::string>::create("-o", "--output", "Output");
+  auto arguments = Argument<std::string>::create(
+      "aargh", Nargs::zero_or_more, "Any arguments you care to provide.");
+  parser->add_option(output);
+  parser->add_arg(arguments);
+
+  const std::string long_eq("--output=out.txt");
+  const std::vector<std::string_view> args{"<exe>", "une", long_eq, "två"};
+  parser->parse_args(args);
+  CHECK(!parser->should_exit());
+  CHECK(output->value() == "out.txt");
+  std::vector<std::string> expected{"une", "två"};
+  CHECK(arguments->values() == expected);
+}
+
+TEST_CASE("ArgCursor") {
+  using namespace ArgParse;
+
+  const char *argv[] = {"<exe>", "-v", "value"};
+  ArgCursor cursor(std::span<char *const>((char **)argv, 3));
+  CHECK(cursor.size() == 3);
+  CHECK(cursor.front() == "<exe>");
+  cursor.pop_front();
+  CHECK(cursor.index() == 1);
+  CHECK(cursor.front() == "-v");
+  cursor.pop_front();
+  cursor.pop_front();
+  CHECK(cursor.empty());
+  CHECK(cursor.size() == 0);
+}
+
 TEST_CASE("Convenience functions") {
   using namespace ArgParse;
 
@@ -552,4 +1370,981 @@ TEST_CASE("Convenience functions") {
     std::vector<double> some_expected{2.0, 3.0};
     CHECK(some->values() == some_expected);
   }
-}
\ No newline at end of file
+}
+namespace {
+// Counts the bytes outstanding.  Memory comes from malloc rather than from
+// the global operator new, so that the two can be counted apart.
+struct CountingResource : public std::pmr::memory_resource {
+  size_t m_num_allocations{0};
+  size_t m_bytes_in_use{0};
+
+private:
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    ++m_num_allocations;
+    m_bytes_in_use += bytes;
+    const size_t size =
+        std::max(alignment, (bytes + alignment - 1) / alignment * alignment);
+    if (void *p = std::aligned_alloc(alignment, size)) {
+      return p;
+    }
+    throw std::bad_alloc();
+  }
+
+  void do_deallocate(void *p, size_t bytes, size_t /*alignment*/) override {
+    m_bytes_in_use -= bytes;
+    std::free(p);
+  }
+
+  [[nodiscard]] bool
+  do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+// Makes any use of the default memory resource fail, while it lives.
+struct NoDefaultResource {
+  NoDefaultResource()
+      : m_previous(
+            std::pmr::set_default_resource(std::pmr::null_memory_resource())) {}
+  ~NoDefaultResource() { std::pmr::set_default_resource(m_previous); }
+
+  NoDefaultResource(const NoDefaultResource &) = delete;
+  NoDefaultResource &operator=(const NoDefaultResource &) = delete;
+
+  std::pmr::memory_resource *m_previous;
+};
+
+// Calls to the global operator new.
+std::atomic<size_t> num_global_allocations{0};
+} // namespace
+
+void *operator new(size_t size) {
+  ++num_global_allocations;
+  if (void *p = std::malloc((size == 0) ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t /*size*/) noexcept { std::free(p); }
+
+TEST_CASE("Memory resources") {
+  using namespace ArgParse;
+
+  CountingResource arena;
+  {
+    auto parser = ArgumentParser::create("Parse in an arena.", &arena);
+    CHECK(parser->resource() == &arena);
+
+    auto verbose = flag(parser, "-v", "--verbose",
+                        "A flag with a help message too long for SSO.");
+    auto output = option<std::filesystem::path>(parser, "-o", "--output",
+                                                "Where to write the output.");
+    auto mode = choice(parser, "-m", "--mode", "Mode.", {"fast", "slow"});
+    auto values = argument<int>(parser, "values", Nargs::one_or_more,
+                                "Values to process.");
+    const size_t num_setup_allocations = arena.m_num_allocations;
+    CHECK(num_setup_allocations > 0);
+
+    const std::vector<std::string_view> args{
+        "<exe>", "-v", "--mode=slow", "1", "2", "3", "4", "5", "6"};
+    size_t num_global = num_global_allocations;
+    {
+      const NoDefaultResource no_default;
+      parser->parse_args(args);
+    }
+    num_global = num_global_allocations - num_global;
+    CHECK(!parser->should_exit());
+    CHECK(verbose->is_set());
+    CHECK(mode->value() == "slow");
+    CHECK(values->values() == std::vector<int>{1, 2, 3, 4, 5, 6});
+
+    // Positional values are stored in the arena, and nothing is allocated
+    // elsewhere.
+    CHECK(arena.m_num_allocations > num_setup_allocations);
+    CHECK(num_global == 0);
+
+    // Rejected values allocate nothing when output is discarded.
+    parser->set_output(OutputSink::discard());
+    const std::vector<std::string_view> invalid{"<exe>", "--mode=medium",
+                                                "1", "x"};
+    parser->reset();
+    num_global = num_global_allocations;
+    {
+      const NoDefaultResource no_default;
+      parser->parse_args(invalid);
+    }
+    num_global = num_global_allocations - num_global;
+    CHECK(parser->should_exit());
+    CHECK(num_global == 0);
+  }
+  CHECK(arena.m_bytes_in_use == 0);
+}
+
+TEST_CASE("Reusing a parser") {
+  using namespace ArgParse;
+
+  CountingResource arena;
+  auto parser = ArgumentParser::create("Parse repeatedly.", &arena);
+  auto verbose = flag(parser, "-v", "--verbose", "Be verbose.");
+  auto count = option<int>(parser, "-n", "--count", "How many.", 3);
+  auto values =
+      argument<int>(parser, "values", Nargs::one_or_more, "Values to sum.");
+
+  const std::vector<std::string_view> first{"<exe>", "-v", "--count=7", "1",
+                                            "2", "3"};
+  parser->parse_args(first);
+  CHECK(!parser->should_exit());
+  CHECK(verbose->is_set());
+  CHECK(count->value() == 7);
+  CHECK(values->values() == std::vector<int>{1, 2, 3});
+
+  SECTION("Reset restores defaults") {
+    parser->reset();
+    CHECK(!verbose->is_set());
+    CHECK(count->value() == 3);
+    CHECK(values->values().empty());
+    CHECK(!values->is_complete());
+  }
+
+  SECTION("Reparse without allocating") {
+    const size_t num_allocations = arena.m_num_allocations;
+    const std::vector<std::string_view> second{"<exe>", "4", "5"};
+    parser->reset();
+    parser->parse_args(second);
+    CHECK(!parser->should_exit());
+    CHECK(!verbose->is_set());
+    CHECK(count->value() == 3);
+    CHECK(values->values() == std::vector<int>{4, 5});
+    CHECK(arena.m_num_allocations == num_allocations);
+  }
+
+  SECTION("Reset clears errors") {
+    const std::vector<std::string_view> invalid{"<exe>", "--count=x", "1"};
+    parser->reset();
+    Tests::ArgParseResult apr(parser, {invalid.begin(), invalid.end()}, true,
+                              1);
+    CHECK(apr.check_outcome());
+
+    parser->reset();
+    CHECK(!parser->should_exit());
+    CHECK(parser->exit_code() == 0);
+    parser->parse_args(first);
+    CHECK(!parser->should_exit());
+    CHECK(values->values() == std::vector<int>{1, 2, 3});
+  }
+}
+
+TEST_CASE("Compiled parsers") {
+  using namespace ArgParse;
+
+  auto parser = ArgumentParser::create("Parse from many threads.");
+  auto verbose = flag(parser, "-v", "--verbose", "Be verbose.");
+  auto count = option<int>(parser, "-n", "--count", "How many.", 3);
+  auto mode = choice(parser, "-m", "--mode", "Mode.", {"fast", "slow"});
+  auto values =
+      argument<int>(parser, "values", Nargs::one_or_more, "Values to sum.");
+  const auto compiled = parser->compile();
+
+  SECTION("Results go to the context") {
+    const std::vector<std::string_view> args{"<exe>", "-v", "--count=7",
+                                             "--mode", "slow", "1", "2"};
+    const auto context = compiled->parse_args(args);
+    CHECK(!context.should_exit());
+    CHECK(context.is_set(verbose));
+    CHECK(context.value(count) == 7);
+    CHECK(context.value(mode) == "slow");
+    CHECK(context.values(values) == std::vector<int>{1, 2});
+
+    // The specs are untouched.
+    CHECK(!verbose->is_set());
+    CHECK(count->value() == 3);
+    CHECK(values->values().empty());
+  }
+
+  SECTION("Defaults") {
+    const std::vector<std::string_view> args{"<exe>", "4"};
+    const auto context = compiled->parse_args(args);
+    CHECK(!context.should_exit());
+    CHECK(!context.is_set(verbose));
+    CHECK(context.value(count) == 3);
+    CHECK(context.value(mode) == "fast");
+  }
+
+  SECTION("Contexts allocate from the given resource") {
+    const std::vector<std::string_view> args{"<exe>", "-n", "5", "1", "2"};
+    CountingResource arena;
+    {
+      const auto context = compiled->parse_args(args, &arena);
+      CHECK(!context.should_exit());
+      CHECK(context.value(count) == 5);
+      CHECK(context.values(values) == std::vector<int>{1, 2});
+      CHECK(arena.m_num_allocations > 0);
+    }
+    CHECK(arena.m_bytes_in_use == 0);
+  }
+
+  SECTION("Errors") {
+    const std::vector<std::string_view> args{"<exe>", "--count=x", "1"};
+    std::ostringstream cerrs;
+    {
+      Tests::Redirect cerr_capture(cerrs, std::cerr);
+      const auto context = compiled->parse_args(args);
+      CHECK(context.should_exit());
+      CHECK(context.exit_code() == 1);
+    }
+    CHECK(cerrs.str().find("'x'") != std::string::npos);
+    CHECK(!parser->should_exit());
+  }
+
+  SECTION("Help") {
+    const std::vector<std::string_view> args{"<exe>", "--help"};
+    std::ostringstream couts;
+    {
+      Tests::Redirect cout_capture(couts, std::cout);
+      const auto context = compiled->parse_args(args);
+      CHECK(context.should_exit());
+      CHECK(context.exit_code() == 0);
+    }
+    CHECK(couts.str().find("Parse from many threads.") != std::string::npos);
+  }
+
+  SECTION("Missing argument") {
+    const std::vector<std::string_view> args{"<exe>", "-v"};
+    std::ostringstream cerrs;
+    {
+      Tests::Redirect cerr_capture(cerrs, std::cerr);
+      CHECK(compiled->parse_args(args).should_exit());
+    }
+    CHECK(cerrs.str().find("Wrong number") != std::string::npos);
+  }
+
+  SECTION("Specs added after compiling") {
+    auto late = flag(parser, "-l", "--late", "Added late.");
+    const std::vector<std::string_view> args{"<exe>", "1"};
+    const auto context = compiled->parse_args(args);
+    CHECK_THROWS_AS(context.is_set(late), std::invalid_argument);
+  }
+
+  SECTION("Concurrent parses") {
+    constexpr int num_threads = 8;
+    constexpr int num_parses = 200;
+    std::vector<int> mismatches(num_threads, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t]() {
+        const std::string count_str = std::to_string(t);
+        const std::string value_str = std::to_string(t * 10);
+        const std::vector<std::string_view> args{"<exe>", "-n", count_str,
+                                                 value_str};
+        for (int i = 0; i < num_parses; ++i) {
+          const auto context = compiled->parse_args(args);
+          if (context.should_exit() || (context.value(count) != t) ||
+              (context.values(values) != std::vector<int>{t * 10})) {
+            ++mismatches[t];
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    CHECK(mismatches == std::vector<int>(num_threads, 0));
+  }
+}
+
+namespace {
+// Writes a temporary file which is removed when it goes out of scope.
+struct TempFile {
+  std::filesystem::path m_path;
+
+  TempFile(const std::string &name, const std::string &contents)
+      : m_path(std::filesystem::temp_directory_path() / name) {
+    std::ofstream outs(m_path);
+    outs << contents;
+  }
+
+  ~TempFile() { std::filesystem::remove(m_path); }
+
+  [[nodiscard]] std::string arg() const { return "@" + m_path.string(); }
+};
+} // namespace
+
+TEST_CASE("Response files") {
+  using namespace ArgParse;
+
+  auto parser = ArgumentParser::create("Read arguments from files.");
+  auto verbose = flag(parser, "-v", "--verbose", "Be verbose.");
+  auto name = option<std::string>(parser, "-n", "--name", "A name.");
+  auto files =
+      argument<std::string>(parser, "files", Nargs::zero_or_more, "Files.");
+
+  TempFile inner("arg_parse_inner.rsp", "c.txt\n'd e.txt'\n");
+  TempFile outer("arg_parse_outer.rsp",
+                 "-v --name \"Jo Smith\"\n\tb.txt " + inner.arg() + "\n");
+
+  SECTION("Disabled by default") {
+    const std::string arg = outer.arg();
+    const std::vector<std::string_view> args{"<exe>", arg};
+    parser->parse_args(args);
+    CHECK(!parser->should_exit());
+    CHECK(files->values() == std::vector<std::string>{arg});
+  }
+
+  parser->enable_response_files();
+
+  SECTION("Nested files") {
+    const std::string arg = outer.arg();
+    const std::vector<std::string_view> args{"<exe>", "a.txt", arg, "f.txt"};
+    parser->parse_args(args);
+    CHECK(!parser->should_exit());
+    CHECK(verbose->is_set());
+    CHECK(name->value() == "Jo Smith");
+    CHECK(files->values() == std::vector<std::string>{"a.txt", "b.txt",
+                                                      "c.txt", "d e.txt",
+                                                      "f.txt"});
+  }
+
+  SECTION("Compiled parsers") {
+    const auto compiled = parser->compile();
+    const std::string arg = inner.arg();
+    const std::vector<std::string_view> args{"<exe>", arg};
+    const auto context = compiled->parse_args(args);
+    CHECK(!context.should_exit());
+    CHECK(context.values(files) ==
+          std::vector<std::string>{"c.txt", "d e.txt"});
+  }
+
+  SECTION("Missing file") {
+    const std::vector<std::string_view> args{"<exe>",
+                                             "@/no/such/arg_parse.rsp"};
+    std::ostringstream cerrs;
+    {
+      Tests::Redirect cerr_capture(cerrs, std::cerr);
+      parser->parse_args(args);
+    }
+    CHECK(parser->should_exit());
+    CHECK(parser->exit_code() == 1);
+    CHECK(cerrs.str().find("Cannot read response file") != std::string::npos);
+  }
+
+  SECTION("Cycles") {
+    const auto cycle_path =
+        std::filesystem::temp_directory_path() / "arg_parse_cycle.rsp";
+    TempFile cycle("arg_parse_cycle.rsp", "a.txt @" + cycle_path.string());
+    const std::string arg = cycle.arg();
+    const std::vector<std::string_view> args{"<exe>", arg};
+    std::ostringstream cerrs;
+    {
+      Tests::Redirect cerr_capture(cerrs, std::cerr);
+      parser->parse_args(args);
+    }
+    CHECK(parser->should_exit());
+    CHECK(cerrs.str().find("includes itself") != std::string::npos);
+  }
+
+  SECTION("Unterminated quote") {
+    TempFile unterminated("arg_parse_quote.rsp", "a.txt 'b.txt");
+    const std::string arg = unterminated.arg();
+    const std::vector<std::string_view> args{"<exe>", arg};
+    std::ostringstream cerrs;
+    {
+      Tests::Redirect cerr_capture(cerrs, std::cerr);
+      parser->parse_args(args);
+    }
+    CHECK(parser->should_exit());
+    CHECK(cerrs.str().find("Unterminated quote") != std::string::npos);
+  }
+}
+
+TEST_CASE("Streaming arguments") {
+  using namespace ArgParse;
+
+  auto parser = ArgumentParser::create("Stream values.");
+  std::vector<int> received;
+  auto values = streaming_argument<int>(
+      parser, "values", Nargs::one_or_more, "Values to stream.",
+      [&received](int &&value) { received.push_back(value); });
+
+  SECTION("Values go to the sink") {
+    const std::vector<std::string_view> args{"<exe>", "1", "2", "3"};
+    parser->parse_args(args);
+    CHECK(!parser->should_exit());
+    CHECK(received == std::vector<int>{1, 2, 3});
+    CHECK(values->values().empty());
+    CHECK(values->num_values() == 3);
+    CHECK(values->is_complete());
+
+    parser->reset();
+    CHECK(values->num_values() == 0);
+    CHECK(!values->is_complete());
+  }
+
+  SECTION("Completeness is counted") {
+    const std::vector<std::string_view> args{"<exe>"};
+    std::ostringstream cerrs;
+    {
+      Tests::Redirect cerr_capture(cerrs, std::cerr);
+      parser->parse_args(args);
+    }
+    CHECK(parser->should_exit());
+    CHECK(cerrs.str().find("Expected >= 1, got 0") != std::string::npos);
+  }
+
+  SECTION("Invalid values") {
+    const std::vector<std::string_view> args{"<exe>", "1", "x", "3"};
+    std::ostringstream cerrs;
+    {
+      Tests::Redirect cerr_capture(cerrs, std::cerr);
+      parser->parse_args(args);
+    }
+    CHECK(parser->should_exit());
+    CHECK(received == std::vector<int>{1});
+  }
+
+  SECTION("Compiled parsers") {
+    const auto compiled = parser->compile();
+    const std::vector<std::string_view> args{"<exe>", "4", "5"};
+    const auto context = compiled->parse_args(args);
+    CHECK(!context.should_exit());
+    CHECK(received == std::vector<int>{4, 5});
+    CHECK(context.values(values).empty());
+    CHECK(context.num_values(values) == 2);
+    CHECK(values->num_values() == 0);
+  }
+}
+
+TEST_CASE("Parallel conversion") {
+  using namespace ArgParse;
+
+  auto parser = ArgumentParser::create("Convert values in parallel.");
+  auto scale = option<double>(parser, "-s", "--scale", "Scale.", 1.0);
+  auto values =
+      argument<int64_t>(parser, "values", Nargs::one_or_more, "Values.");
+  values->convert_in_parallel(4);
+
+  std::vector<std::string> strs;
+  for (int i = 0; i < 100; ++i) {
+    strs.push_back(std::to_string(i * 3));
+  }
+  std::vector<std::string_view> args{"<exe>", "-s", "2"};
+  args.insert(args.end(), strs.begin(), strs.end());
+
+  std::vector<int64_t> expected;
+  for (int i = 0; i < 100; ++i) {
+    expected.push_back(i * 3);
+  }
+
+  SECTION("Values") {
+    parser->parse_args(args);
+    CHECK(!parser->should_exit());
+    CHECK(scale->value() == 2.0);
+    CHECK(values->values() == expected);
+    CHECK(values->num_values() == 100);
+  }
+
+  SECTION("The first invalid value is reported") {
+    args[20] = "bad-20";
+    args[90] = "bad-90";
+    std::ostringstream cerrs;
+    {
+      Tests::Redirect cerr_capture(cerrs, std::cerr);
+      parser->parse_args(args);
+    }
+    CHECK(parser->should_exit());
+    CHECK(cerrs.str().find("bad-20") != std::string::npos);
+    CHECK(cerrs.str().find("bad-90") == std::string::npos);
+  }
+
+  SECTION("Too few values") {
+    const std::vector<std::string_view> no_values{"<exe>", "-s", "2"};
+    std::ostringstream cerrs;
+    {
+      Tests::Redirect cerr_capture(cerrs, std::cerr);
+      parser->parse_args(no_values);
+    }
+    CHECK(parser->should_exit());
+    CHECK(cerrs.str().find("Wrong number") != std::string::npos);
+  }
+
+  SECTION("Compiled parsers") {
+    const auto compiled = parser->compile();
+    const auto context = compiled->parse_args(args);
+    CHECK(!context.should_exit());
+    CHECK(context.values(values) == expected);
+    CHECK(context.num_values(values) == 100);
+  }
+
+  SECTION("Reuse") {
+    parser->parse_args(args);
+    parser->reset();
+    parser->parse_args(args);
+    CHECK(values->values() == expected);
+  }
+
+  SECTION("Unconverted values are discarded when parsing stops early") {
+    args.push_back("--help");
+    Tests::ArgParseResult apr(parser, {args.begin(), args.end()}, true, 0);
+    CHECK(apr.check_outcome());
+    CHECK(values->num_values() == 0);
+    CHECK(values->values().empty());
+
+    std::ostringstream couts;
+    Tests::Redirect cout_capture(couts, std::cout);
+    const auto compiled = parser->compile();
+    const auto context = compiled->parse_args(args);
+    CHECK(context.should_exit());
+    CHECK(context.num_values(values) == 0);
+    CHECK(context.values(values).empty());
+  }
+
+  SECTION("Values are converted despite option errors") {
+    args.push_back("--bogus");
+    Tests::ArgParseResult apr(parser, {args.begin(), args.end()}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(values->values() == expected);
+    CHECK(values->num_values() == 100);
+  }
+}
+
+TEST_CASE("Subcommands") {
+  using namespace ArgParse;
+
+  auto parser = ArgumentParser::create("A tool with commands.");
+  auto verbose = flag(parser, "-v", "--verbose", "Be verbose.");
+
+  int num_built = 0;
+  Option<int>::Ptr count;
+  Argument<std::string>::Ptr paths;
+  parser->add_subcommand("add", "Add some files.",
+                         [&](ArgumentParser::Ptr subparser) {
+                           ++num_built;
+                           count = option<int>(subparser, "-n", "--count",
+                                               "How many.", 1);
+                           paths = argument<std::string>(
+                               subparser, "paths", Nargs::one_or_more,
+                               "Files to add.");
+                         });
+  parser->add_subcommand("remove", "Remove some files.",
+                         [&](ArgumentParser::Ptr) {
+                           FAIL("The remove parser should not be built.");
+                         });
+
+  SECTION("Invoke a subcommand") {
+    const std::vector<std::string_view> args{"<exe>", "-v", "add", "-n",
+                                             "3",     "a",  "b"};
+    parser->parse_args(args);
+    CHECK(!parser->should_exit());
+    CHECK(verbose->is_set());
+    CHECK(parser->subcommand() == "add");
+    REQUIRE(parser->subparser());
+    CHECK(num_built == 1);
+    CHECK(count->value() == 3);
+    CHECK(paths->values() == std::vector<std::string>{"a", "b"});
+  }
+
+  SECTION("Help shows summaries without building subparsers") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "--help"}, true, 0);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cout_contains("COMMAND [ARGS ...]"));
+    CHECK(apr.cout_contains("Commands:"));
+    CHECK(apr.cout_contains("add"));
+    CHECK(apr.cout_contains("Remove some files."));
+    CHECK(num_built == 0);
+  }
+
+  SECTION("Subcommand help") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "add", "--help"}, true, 0);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cout_contains("Add some files."));
+    CHECK(apr.cout_contains("Usage: <exe> add"));
+    CHECK(apr.cout_contains("--count"));
+    CHECK(num_built == 1);
+  }
+
+  SECTION("Subcommand errors") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "add", "-n", "x", "a"}, true,
+                              1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains("Usage: <exe> add"));
+  }
+
+  SECTION("Unknown subcommand") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "frob", "a"}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains("Unknown command 'frob'"));
+    CHECK(parser->subcommand().empty());
+    CHECK(!parser->subparser());
+  }
+
+  SECTION("Missing subcommand") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "-v"}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains("Missing command"));
+  }
+
+  SECTION("Subparsers are built once and reset with their parent") {
+    const std::vector<std::string_view> first{"<exe>", "add", "-n", "2", "a"};
+    parser->parse_args(first);
+    CHECK(count->value() == 2);
+
+    parser->reset();
+    CHECK(parser->subcommand().empty());
+    CHECK(count->value() == 1);
+    CHECK(paths->values().empty());
+
+    const std::vector<std::string_view> second{"<exe>", "add", "b"};
+    parser->parse_args(second);
+    CHECK(!parser->should_exit());
+    CHECK(num_built == 1);
+    CHECK(paths->values() == std::vector<std::string>{"b"});
+  }
+
+  SECTION("Invalid definitions") {
+    CHECK_THROWS_AS(
+        parser->add_subcommand("add", "Again.", [](ArgumentParser::Ptr) {}),
+        std::invalid_argument);
+    CHECK_THROWS_AS(argument<int>(parser, "n", Nargs::one, "A number."),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(parser->compile(), std::invalid_argument);
+
+    auto with_args = ArgumentParser::create("Has arguments.");
+    argument<int>(with_args, "n", Nargs::one, "A number.");
+    CHECK_THROWS_AS(
+        with_args->add_subcommand("cmd", "A command.",
+                                  [](ArgumentParser::Ptr) {}),
+        std::invalid_argument);
+  }
+}
+
+namespace {
+void set_env(const char *name, const char *value) {
+#if defined(_WIN32)
+  _putenv_s(name, value);
+#else
+  setenv(name, value, 1);
+#endif
+}
+} // namespace
+
+TEST_CASE("Environment variables") {
+  using namespace ArgParse;
+
+  SECTION("Indexing an environment") {
+    const char *envp[] = {"A=1", "B=", "A=2", "NO_VALUE", "=x", "C=a=b",
+                          nullptr};
+    const Internal::EnvIndex env(envp);
+    CHECK(env.find("A") == "1");
+    CHECK(env.find("B") == "");
+    CHECK(env.find("C") == "a=b");
+    CHECK(!env.find("NO_VALUE"));
+    CHECK(!env.find("D"));
+  }
+
+  set_env("ARG_PARSE_TEST_COUNT", "5");
+  set_env("ARG_PARSE_TEST_VERBOSE", "1");
+  set_env("ARG_PARSE_TEST_BAD", "lots");
+
+  auto parser = ArgumentParser::create("Read the environment.");
+  auto count = option<int>(parser, "-n", "--count", "How many.", 1);
+  count->set_env_var("ARG_PARSE_TEST_COUNT");
+  auto verbose = flag(parser, "-v", "--verbose", "Be verbose.");
+  verbose->set_env_var("ARG_PARSE_TEST_VERBOSE");
+  auto size = option<int>(parser, "-s", "--size", "How big.", 7);
+  size->set_env_var("ARG_PARSE_TEST_UNSET");
+
+  SECTION("The environment overrides defaults") {
+    const std::vector<std::string_view> args{"<exe>"};
+    parser->parse_args(args);
+    CHECK(!parser->should_exit());
+    CHECK(count->value() == 5);
+    CHECK(verbose->is_set());
+    CHECK(size->value() == 7);
+  }
+
+  SECTION("The command line overrides the environment") {
+    const std::vector<std::string_view> args{"<exe>", "--count=9"};
+    parser->parse_args(args);
+    CHECK(count->value() == 9);
+  }
+
+  SECTION("Invalid variables") {
+    auto width = option<int>(parser, "-w", "--width", "How wide.");
+    width->set_env_var("ARG_PARSE_TEST_BAD");
+
+    Tests::ArgParseResult apr(parser, {"<exe>"}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains("ARG_PARSE_TEST_BAD"));
+    CHECK(apr.cerr_contains("lots"));
+
+    // An invalid variable doesn't matter if the command line overrides it.
+    parser->reset();
+    Tests::ArgParseResult overridden(parser, {"<exe>", "-w", "3"}, false, 0);
+    CHECK(overridden.check_outcome());
+    CHECK(width->value() == 3);
+  }
+
+  SECTION("Help shows the variables") {
+    Tests::ArgParseResult apr(parser, {"<exe>", "--help"}, true, 0);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cout_contains("How many.  [env: ARG_PARSE_TEST_COUNT]"));
+    CHECK(apr.cout_contains("Be verbose.  [env: ARG_PARSE_TEST_VERBOSE]"));
+  }
+
+  SECTION("Compiled parsers") {
+    const auto compiled = parser->compile();
+    const std::vector<std::string_view> args{"<exe>", "-s", "2"};
+    const auto context = compiled->parse_args(args);
+    CHECK(!context.should_exit());
+    CHECK(context.value(count) == 5);
+    CHECK(context.is_set(verbose));
+    CHECK(context.value(size) == 2);
+  }
+
+  SECTION("Variables set after parsing") {
+    auto plain = ArgumentParser::create("Set a variable later.");
+    auto later = option<int>(plain, "-l", "--later", "How late.", 1);
+    const auto compiled = plain->compile();
+    Tests::ArgParseResult before(plain, {"<exe>", "-h"}, true, 0);
+    CHECK(before.check_outcome());
+    CHECK(!before.cout_contains("[env: ARG_PARSE_TEST_COUNT]"));
+
+    plain->reset();
+    later->set_env_var("ARG_PARSE_TEST_COUNT");
+    Tests::ArgParseResult after(plain, {"<exe>", "-h"}, true, 0);
+    CHECK(after.check_outcome());
+    CHECK(after.cout_contains("How late.  [env: ARG_PARSE_TEST_COUNT]"));
+
+    plain->reset();
+    plain->parse_args(ArgSeq{"<exe>"});
+    CHECK(later->value() == 5);
+
+    // The compiled parser keeps the variables set when it was compiled.
+    const std::vector<std::string_view> args{"<exe>"};
+    const auto context = compiled->parse_args(args);
+    CHECK(!context.should_exit());
+    CHECK(context.value(later) == 1);
+    CHECK(plain->compile()->parse_args(args).value(later) == 5);
+  }
+}
+
+TEST_CASE("Config files") {
+  using namespace ArgParse;
+
+  SECTION("Indexing a config file") {
+    Internal::ConfigFile config;
+    const std::string_view text = "# A comment\n"
+                                  "name = Jo  # Another\n"
+                                  "; Yet another\n"
+                                  "  width=3\r\n"
+                                  "name = 'Jo # Smith'\n"
+                                  "empty =\n"
+                                  "[ server ]\n"
+                                  "name = \"main\"\n";
+    CHECK(!config.parse(text, "test.ini"));
+    CHECK(config.size() == 4);
+    CHECK(config.find("", "name") == "Jo # Smith");
+    CHECK(config.find("", "width") == "3");
+    CHECK(config.find("", "empty") == "");
+    CHECK(config.find("server", "name") == "main");
+    CHECK(!config.find("server", "width"));
+    CHECK(!config.find("", "missing"));
+  }
+
+  SECTION("Malformed config files") {
+    Internal::ConfigFile config;
+    const auto err_msg = config.parse("a = 1\nb\n", "bad.ini");
+    REQUIRE(err_msg);
+    CHECK(err_msg.value() == "Expected 'key = value' on line 2 of config "
+                             "file 'bad.ini'.");
+    CHECK(config.parse("[a\n", "bad.ini"));
+    CHECK(config.parse("= 1\n", "bad.ini"));
+    CHECK(config.parse("a = 'b\n", "bad.ini"));
+    CHECK(config.parse("a = 'b' c\n", "bad.ini"));
+  }
+
+  set_env("ARG_PARSE_TEST_CONFIG_SIZE", "8");
+
+  auto parser = ArgumentParser::create("Read a config file.");
+  auto count = option<int>(parser, "-n", "--count", "How many.", 1);
+  auto verbose = flag(parser, "-v", "--verbose", "Be verbose.");
+  auto size = option<int>(parser, "-s", "--size", "How big.", 7);
+  size->set_env_var("ARG_PARSE_TEST_CONFIG_SIZE");
+  auto name = option<std::string>(parser, "", "--name", "A name.");
+
+  TempFile file("arg_parse_test.ini", "count = 5\n"
+                                      "verbose = true\n"
+                                      "size = 6\n"
+                                      "unknown = ignored\n"
+                                      "[add]\n"
+                                      "count = 4\n");
+  REQUIRE(!parser->load_config(file.m_path.string()));
+
+  SECTION("The config file overrides defaults") {
+    const std::vector<std::string_view> args{"<exe>"};
+    parser->parse_args(args);
+    CHECK(!parser->should_exit());
+    CHECK(count->value() == 5);
+    CHECK(verbose->is_set());
+    CHECK(name->value().empty());
+  }
+
+  SECTION("The environment and command line override the config file") {
+    const std::vector<std::string_view> args{"<exe>", "--count=9"};
+    parser->parse_args(args);
+    CHECK(count->value() == 9);
+    CHECK(size->value() == 8);
+  }
+
+  SECTION("Invalid values") {
+    TempFile bad("arg_parse_bad.ini", "count = lots\n");
+    REQUIRE(!parser->load_config(bad.m_path.string()));
+
+    Tests::ArgParseResult apr(parser, {"<exe>"}, true, 1);
+    CHECK(apr.check_outcome());
+    CHECK(apr.cerr_contains("Invalid value for 'count': 'lots'"));
+
+    parser->reset();
+    Tests::ArgParseResult overridden(parser, {"<exe>", "-n", "3"}, false, 0);
+    CHECK(overridden.check_outcome());
+    CHECK(count->value() == 3);
+  }
+
+  SECTION("Unreadable files leave the parser unchanged") {
+    const auto err_msg = parser->load_config("/no/such/arg_parse.ini");
+    REQUIRE(err_msg);
+    CHECK(err_msg->starts_with("Cannot read config file"));
+
+    const std::vector<std::string_view> args{"<exe>"};
+    parser->parse_args(args);
+    CHECK(count->value() == 5);
+  }
+
+  SECTION("Subcommands read their own sections") {
+    Option<int>::Ptr add_count;
+    parser->add_subcommand("add", "Add things.",
+                           [&](ArgumentParser::Ptr subparser) {
+                             add_count = option<int>(subparser, "-n",
+                                                     "--count", "How many.");
+                           });
+    const std::vector<std::string_view> args{"<exe>", "add"};
+    parser->parse_args(args);
+    CHECK(!parser->should_exit());
+    CHECK(count->value() == 5);
+    CHECK(add_count->value() == 4);
+  }
+
+  SECTION("Compiled parsers") {
+    const auto compiled = parser->compile();
+    const std::vector<std::string_view> args{"<exe>", "-v"};
+    const auto context = compiled->parse_args(args);
+    CHECK(!context.should_exit());
+    CHECK(context.value(count) == 5);
+    CHECK(context.value(size) == 8);
+  }
+}
+
+TEST_CASE("Shell completion") {
+  using namespace ArgParse;
+
+  const auto cache_dir =
+      std::filesystem::temp_directory_path() / "arg_parse_test_cache";
+  std::filesystem::remove_all(cache_dir);
+  set_env("XDG_CACHE_HOME", cache_dir.string().c_str());
+
+  auto parser = ArgumentParser::create("Complete command lines.");
+  auto sink = std::make_shared<CaptureSink>();
+  parser->set_output(sink);
+  flag(parser, "-v", "--verbose", "Be verbose.");
+  option<int>(parser, "-n", "--count", "How many.");
+  choice(parser, "-m", "--mode", "How.", {"fast", "slow"});
+  auto branch = option<std::string>(parser, "-b", "--branch", "Which.");
+  int num_listed = 0;
+  parser->set_completer(
+      branch,
+      [&num_listed] {
+        ++num_listed;
+        return std::vector<std::string>{"main", "maint", "topic"};
+      },
+      std::chrono::seconds(60));
+  Flag::Ptr force;
+  parser->add_subcommand("add", "Add files.",
+                         [&force](ArgumentParser::Ptr subparser) {
+                           force = flag(subparser, "-f", "--force",
+                                        "Overwrite.");
+                         });
+
+  // Answer the candidates for a command line, the last word of which is
+  // being completed.
+  const auto complete = [&](std::vector<std::string_view> words) {
+    const std::string cword = std::to_string(words.size() - 1);
+    words.insert(words.begin(), {"<exe>", "--__complete", cword});
+    parser->reset();
+    sink->m_outs.clear();
+    parser->parse_args(words);
+    CHECK(parser->should_exit());
+    CHECK(parser->exit_code() == 0);
+    REQUIRE(sink->m_outs.size() == 1);
+    return sink->m_outs.front();
+  };
+
+  SECTION("Option names") {
+    CHECK(complete({"prog", "--c"}) == "--count\n");
+    CHECK(complete({"prog", "-v", "--"}) ==
+          "--branch\n--count\n--help\n--mode\n--verbose\n");
+    CHECK(complete({"prog", "--x"}).empty());
+  }
+
+  SECTION("Choices") {
+    CHECK(complete({"prog", "-m", ""}) == "fast\nslow\n");
+    CHECK(complete({"prog", "--mode", "f"}) == "fast\n");
+    CHECK(complete({"prog", "--mode=s"}) == "--mode=slow\n");
+  }
+
+  SECTION("Subcommands") {
+    CHECK(complete({"prog", "-n", "3", ""}) == "add\n");
+    CHECK(complete({"prog", "add", "--f"}) == "--force\n");
+    CHECK(complete({"prog", "nope", "--f"}).empty());
+  }
+
+  SECTION("Completers are cached") {
+    CHECK(complete({"prog", "-b", "mai"}) == "main\nmaint\n");
+    CHECK(complete({"prog", "--branch=t"}) == "--branch=topic\n");
+    CHECK(num_listed == 1);
+    CHECK(std::filesystem::exists(cache_dir / "arg_parse"));
+
+    // Another parser of the same program reads the cache.
+    auto other = ArgumentParser::create("Complete command lines.");
+    other->set_output(sink);
+    auto other_branch = option<std::string>(other, "-b", "--branch", "");
+    other->set_completer(
+        other_branch, [] { return std::vector<std::string>{"stale"}; },
+        std::chrono::seconds(60));
+    sink->m_outs.clear();
+    const std::vector<std::string_view> args{"<exe>", "--__complete", "2",
+                                             "prog",  "-b",           ""};
+    other->parse_args(args);
+    REQUIRE(sink->m_outs.size() == 1);
+    CHECK(sink->m_outs.front() == "main\nmaint\ntopic\n");
+  }
+
+  SECTION("Invalid requests") {
+    const std::vector<std::string_view> args{"<exe>", "--__complete", "5",
+                                             "prog"};
+    parser->parse_args(args);
+    CHECK(parser->exit_code() == 1);
+    CHECK(sink->m_outs.empty());
+  }
+
+  SECTION("Completers are for the parser's own options") {
+    auto stray = Option<int>::create("-s", "--stray", "Not added.");
+    CHECK_THROWS_AS(parser->set_completer(
+                        stray, [] { return std::vector<std::string>{}; },
+                        std::chrono::seconds(0)),
+                    std::invalid_argument);
+  }
+
+  std::filesystem::remove_all(cache_dir);
+}
@@ -0,0 +1,113 @@
+#include "argument.hpp"
+#include "argument_parser.hpp"
+#include "command_line.hpp"
+#include "option.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+using Args = std::vector<std::string>;
+
+// Copies the arguments, which may view storage owned by the CommandLine.
+Args split(std::string_view line) {
+  const auto command_line = ArgParse::split_command_line(line);
+  return {command_line.args().begin(), command_line.args().end()};
+}
+
+bool views(std::string_view line, std::string_view arg) {
+  return (arg.data() >= line.data()) &&
+         (arg.data() + arg.size() <= line.data() + line.size());
+}
+} // namespace
+
+TEST_CASE("Splitting command lines") {
+  using namespace ArgParse;
+
+  SECTION("Whitespace") {
+    CHECK(split("").empty());
+    CHECK(split(" \t\n ").empty());
+    CHECK(split("cmd") == Args{"cmd"});
+    CHECK(split("  cmd\t-v\n--name=x  ") == Args{"cmd", "-v", "--name=x"});
+  }
+
+  SECTION("Quotes") {
+    CHECK(split(R"(cmd 'a b' "c d")") == Args{"cmd", "a b", "c d"});
+    CHECK(split(R"(cmd '' "")") == Args{"cmd", "", ""});
+    CHECK(split(R"(cmd 'a "b"' "c 'd'")") == Args{"cmd", R"(a "b")", "c 'd'"});
+    CHECK(split(R"(cmd --name="Jo Smith" a'b'c)") ==
+          Args{"cmd", "--name=Jo Smith", "abc"});
+  }
+
+  SECTION("Backslashes") {
+    CHECK(split(R"(cmd a\ b \'c\' \\)") == Args{"cmd", "a b", "'c'", "\\"});
+    CHECK(split(R"(cmd 'a\b')") == Args{"cmd", R"(a\b)"});
+    CHECK(split(R"(cmd "a\"b\\c\d\$")") == Args{"cmd", R"(a"b\c\d$)"});
+    CHECK(split("cmd a\\\nb \\\n c") == Args{"cmd", "ab", "c"});
+    CHECK(split("cmd \"a\\\nb\"") == Args{"cmd", "ab"});
+    CHECK(split("cmd a\\") == Args{"cmd", "a\\"});
+  }
+
+  SECTION("Unterminated quotes") {
+    CHECK_THROWS_AS(split("cmd 'a"), std::invalid_argument);
+    CHECK_THROWS_AS(split("cmd \"a"), std::invalid_argument);
+    CHECK_THROWS_AS(split("cmd \"a\\\""), std::invalid_argument);
+  }
+
+  SECTION("Arguments view the line where possible") {
+    const std::string line(R"(cmd plain "quoted words" 'single' mi"x"ed)");
+    const auto command_line = split_command_line(line);
+    const auto args = command_line.args();
+    REQUIRE(args.size() == 5);
+    CHECK(views(line, args[1]));
+    CHECK(views(line, args[2]));
+    CHECK(views(line, args[3]));
+    CHECK(!views(line, args[4]));
+    CHECK(args[4] == "mixed");
+  }
+
+  SECTION("Long lines") {
+    // Long enough to exercise vectorized scanning.
+    std::string line("cmd");
+    Args expected{"cmd"};
+    std::vector<std::string> words;
+    for (int i = 0; i < 50; ++i) {
+      words.push_back("word-" + std::to_string(i) + "-padded-out-to-length");
+    }
+    for (int i = 0; i < 50; ++i) {
+      line += (i % 2) ? " \"" + words[i] + " x\\\"y\"" : " " + words[i];
+    }
+    const auto command_line = split_command_line(line);
+    REQUIRE(command_line.args().size() == 51);
+    for (int i = 0; i < 50; ++i) {
+      const auto expected_arg = (i % 2) ? words[i] + " x\"y" : words[i];
+      CHECK(command_line.args()[i + 1] == expected_arg);
+    }
+  }
+
+  SECTION("Reuse") {
+    CommandLine command_line("cmd \"a\\\"b\"");
+    command_line.assign("other 'c d' e\\ f");
+    CHECK(Args(command_line.args().begin(), command_line.args().end()) ==
+          Args{"other", "c d", "e f"});
+  }
+
+  SECTION("Parsing") {
+    auto parser = ArgumentParser::create("Parse a command line.");
+    auto name = Option<std::string>::create("-n", "--name", "A name.");
+    auto files =
+        Argument<std::string>::create("files", Nargs::one_or_more, "Files.");
+    parser->add_option(name);
+    parser->add_arg(files);
+    const auto command_line =
+        split_command_line(R"(cmd --name 'Jo Smith' a.txt "b c.txt")");
+    parser->parse_args(command_line);
+    CHECK(!parser->should_exit());
+    CHECK(name->value() == "Jo Smith");
+    CHECK(files->values() == std::vector<std::string>{"a.txt", "b c.txt"});
+  }
+}
@@ -0,0 +1,170 @@
+#include "static_parser.hpp"
+#include "redirect.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+using namespace ArgParse::Static;
+
+using Parser =
+    StaticParser<Flag<"-v", "--verbose", "Be verbose.">,
+                 Option<int, "-j", "--jobs", "Number of jobs.">,
+                 Option<std::filesystem::path, "-o", "--output", "Output.">,
+                 Argument<std::string, "dest", Nargs::one, "Destination.">,
+                 Argument<double, "values", Nargs::zero_or_more, "Values.">>;
+
+struct Outcome {
+  bool should_exit;
+  int exit_code;
+  std::string cout;
+  std::string cerr;
+};
+
+Outcome parse(Parser &parser, const std::vector<std::string_view> &args) {
+  std::ostringstream couts;
+  std::ostringstream cerrs;
+  {
+    Tests::Redirect cout_capture(couts, std::cout);
+    Tests::Redirect cerr_capture(cerrs, std::cerr);
+    parser.parse_args(args);
+  }
+  return {parser.should_exit(), parser.exit_code(), couts.str(), cerrs.str()};
+}
+} // namespace
+
+TEST_CASE("StaticParser") {
+  Parser parser("Parse some stuff statically.");
+
+  SECTION("Defaults") {
+    auto outcome = parse(parser, {"<exe>", "there"});
+    CHECK(!outcome.should_exit);
+    CHECK(!parser.get<"--verbose">());
+    CHECK(parser.get<"-j">() == 0);
+    CHECK(parser.get<"dest">() == "there");
+    CHECK(parser.get<"values">().empty());
+    CHECK(parser.count<"--jobs">() == 0);
+  }
+
+  SECTION("Preset defaults") {
+    parser.get<"--jobs">() = 4;
+    auto outcome = parse(parser, {"<exe>", "there"});
+    CHECK(!outcome.should_exit);
+    CHECK(parser.get<"--jobs">() == 4);
+  }
+
+  SECTION("Flags, options and arguments") {
+    auto outcome = parse(parser, {"<exe>", "-v", "--jobs=8", "there", "-o",
+                                  "out.txt", "1.5", "2.5"});
+    CHECK(!outcome.should_exit);
+    CHECK(parser.get<"-v">());
+    CHECK(parser.get<1>() == 8);
+    CHECK(parser.get<"--output">() == std::filesystem::path("out.txt"));
+    CHECK(parser.get<"dest">() == "there");
+    CHECK(parser.get<"values">() == std::vector<double>{1.5, 2.5});
+    CHECK(parser.count<"values">() == 2);
+  }
+
+  SECTION("argc, argv") {
+    const char *argv[] = {"<exe>", "-j", "3", "there"};
+    parser.parse_args(4, (char **)argv);
+    CHECK(!parser.should_exit());
+    CHECK(parser.get<"--jobs">() == 3);
+  }
+
+  SECTION("Help") {
+    auto outcome = parse(parser, {"<exe>", "--help"});
+    CHECK(outcome.should_exit);
+    CHECK(outcome.exit_code == 0);
+    CHECK(outcome.cout.find("Parse some stuff statically.") !=
+          std::string::npos);
+    CHECK(outcome.cout.find("[-j|--jobs JOBS]") != std::string::npos);
+    CHECK(outcome.cout.find("DEST [VALUES ...]") != std::string::npos);
+    CHECK(outcome.cout.find("Number of jobs.") != std::string::npos);
+  }
+
+  SECTION("Unknown option") {
+    auto outcome = parse(parser, {"<exe>", "--jobz", "3", "there"});
+    CHECK(outcome.should_exit);
+    CHECK(outcome.exit_code == 1);
+    CHECK(outcome.cerr.find("Unknown option '--jobz'") != std::string::npos);
+  }
+
+  SECTION("Missing option value") {
+    auto outcome = parse(parser, {"<exe>", "there", "--jobs"});
+    CHECK(outcome.should_exit);
+    CHECK(outcome.cerr.find("No value provided") != std::string::npos);
+  }
+
+  SECTION("Flag with value") {
+    auto outcome = parse(parser, {"<exe>", "there", "--verbose=1"});
+    CHECK(outcome.should_exit);
+    CHECK(outcome.cerr.find("Unexpected value") != std::string::npos);
+  }
+
+  SECTION("Invalid value") {
+    auto outcome = parse(parser, {"<exe>", "there", "1.5", "x"});
+    CHECK(outcome.should_exit);
+    CHECK(outcome.cerr.find("'x'") != std::string::npos);
+  }
+
+  SECTION("Missing positional") {
+    auto outcome = parse(parser, {"<exe>", "-v"});
+    CHECK(outcome.should_exit);
+    CHECK(outcome.cerr.find("Wrong number") != std::string::npos);
+  }
+
+  SECTION("Too many positionals") {
+    StaticParser<Argument<int, "n", Nargs::one>> one_arg("One argument.");
+    std::vector<std::string_view> args{"<exe>", "1", "2"};
+    std::ostringstream cerrs;
+    {
+      Tests::Redirect cerr_capture(cerrs, std::cerr);
+      one_arg.parse_args(args);
+    }
+    CHECK(one_arg.should_exit());
+    CHECK(one_arg.get<"n">() == 1);
+    CHECK(cerrs.str().find("Unsupported argument(s): 2") != std::string::npos);
+  }
+
+  SECTION("Short names take no =value") {
+    auto outcome = parse(parser, {"<exe>", "there", "-j=4"});
+    CHECK(outcome.should_exit);
+    CHECK(outcome.exit_code == 1);
+    CHECK(outcome.cerr.find("Unknown option '-j=4'") != std::string::npos);
+
+    outcome = parse(parser, {"<exe>", "there", "-h=x"});
+    CHECK(outcome.should_exit);
+    CHECK(outcome.exit_code == 1);
+    CHECK(outcome.cout.empty());
+  }
+
+  SECTION("Long-only options") {
+    StaticParser<Option<int, "", "--width", "Width.">,
+                 Option<int, "", "--height", "Height.">,
+                 Flag<"", "--dry-run", "Don't.">>
+        long_only("Long names only.");
+    std::vector<std::string_view> args{"<exe>", "--width=3", "--height",
+                                       "4", "--dry-run"};
+    long_only.parse_args(args);
+    CHECK(!long_only.should_exit());
+    CHECK(long_only.get<"--width">() == 3);
+    CHECK(long_only.get<"--height">() == 4);
+    CHECK(long_only.get<"--dry-run">());
+  }
+
+  SECTION("Output sink") {
+    std::ostringstream outs;
+    std::ostringstream errs;
+    parser.set_output(ArgParse::OutputSink::create(outs, errs));
+    std::vector<std::string_view> args{"<exe>", "--jobs=x", "there"};
+    parser.parse_args(args);
+    CHECK(parser.should_exit());
+    CHECK(outs.str().empty());
+    CHECK(errs.str().find("Usage: <exe>") != std::string::npos);
+  }
+}